@@ -20,6 +20,8 @@ namespace hpqueue {
 template <class C, class Base>
 class Access {
 	friend class SampleQueueEntryConsumer;
+	friend struct SampleQueueEntry1Handler;
+	friend struct SampleQueueEntry3Handler;
 
 	C &object;
 
@@ -0,0 +1,234 @@
+/*
+ * InlineBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef BASE_INLINEBUFFER_H_
+#define BASE_INLINEBUFFER_H_
+
+#include <stddef.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Data.h"
+
+namespace hpqueue {
+
+/**
+ * A fixed-capacity buffer of up to N elements of plain data, held within the buffer itself rather than on the heap.
+ *
+ * The buffer is trivially copyable, so a data class whose fields are all trivially copyable, such as these buffers
+ * and primitive types, is trivially copyable too, and can be copied with a fixed-size memcpy with no allocation.
+ *
+ * Contents longer than the capacity are truncated to the capacity, in which case assign returns false.
+ * The elements are always followed by T(), so that a buffer of characters is also a null-terminated string.
+ */
+template <typename T, unsigned int N>
+class InlineBuffer {
+	UINT_32 length;
+
+	T elements[N + 1];
+
+public:
+	static const unsigned int CAPACITY = N;
+
+	InlineBuffer() : length(0) {
+		elements[0] = T();
+	}
+
+	InlineBuffer(const T *values, size_t count) : length(0) {
+		assign(values, count);
+	}
+
+	/*
+	 * Returns false if the values did not fit and were truncated.
+	 */
+	bool assign(const T *values, size_t count) {
+		bool fits = (count <= N);
+		if(!fits) {
+			count = N;
+		}
+		if(count > 0) {
+			std::memmove(elements, values, count * sizeof(T));
+		}
+		length = count;
+		elements[count] = T();
+		return fits;
+	}
+
+	const T *data() const {
+		return elements;
+	}
+
+	size_t size() const {
+		return length;
+	}
+
+	bool empty() const {
+		return length == 0;
+	}
+
+	const T &operator[](size_t index) const {
+		return elements[index];
+	}
+
+	bool operator==(const InlineBuffer &that) const {
+		return length == that.length && std::memcmp(elements, that.elements, length * sizeof(T)) == 0;
+	}
+
+	bool operator!=(const InlineBuffer &that) const {
+		return !(*this == that);
+	}
+};
+
+/**
+ * A string of up to N characters held inline, see InlineBuffer.
+ *
+ * It accepts the same values as string_wrapper: strings, char * and NULL.
+ */
+template <unsigned int N>
+class InlineString : public InlineBuffer<char, N> {
+public:
+	InlineString() {}
+
+	InlineString(const std::string &value) {
+		assign(value);
+	}
+
+	InlineString(const char *value) {
+		assign(value);
+	}
+
+	InlineString(const string_wrapper &value) {
+		assign(value);
+	}
+
+	using InlineBuffer<char, N>::assign;
+
+	bool assign(const std::string &value) {
+		return assign(value.data(), value.length());
+	}
+
+	bool assign(const char *value) {
+		return (value == NULL) ? assign(Data::emptyChars, 0) : assign(value, std::strlen(value));
+	}
+
+	bool assign(const string_wrapper &value) {
+		return assign(static_cast<const std::string &>(value));
+	}
+
+	InlineString &operator=(const std::string &value) {
+		assign(value);
+		return *this;
+	}
+
+	InlineString &operator=(const char *value) {
+		assign(value);
+		return *this;
+	}
+
+	const char *c_str() const {
+		return this->data();
+	}
+
+	std::string str() const {
+		return std::string(this->data(), this->size());
+	}
+};
+
+/**
+ * A byte buffer of up to N bytes held inline, see InlineBuffer.
+ *
+ * It accepts the same values as byte_vector_wrapper: byte vectors, null-terminated byte or char arrays, and NULL.
+ */
+template <unsigned int N>
+class InlineBytes : public InlineBuffer<INT_8, N> {
+public:
+	InlineBytes() {}
+
+	InlineBytes(const std::vector<INT_8> &value) {
+		assign(value);
+	}
+
+	InlineBytes(const byte_vector_wrapper &value) {
+		assign(value);
+	}
+
+	InlineBytes(const INT_8 *value, size_t count) : InlineBuffer<INT_8, N>(value, count) {}
+
+	using InlineBuffer<INT_8, N>::assign;
+
+	bool assign(const std::vector<INT_8> &value) {
+		return value.empty() ? assign(NULL, 0) : assign(&value[0], value.size());
+	}
+
+	bool assign(const byte_vector_wrapper &value) {
+		return assign(static_cast<const std::vector<INT_8> &>(value));
+	}
+
+	InlineBytes &operator=(const std::vector<INT_8> &value) {
+		assign(value);
+		return *this;
+	}
+
+	std::vector<INT_8> vector() const {
+		return std::vector<INT_8>(this->data(), this->data() + this->size());
+	}
+};
+
+/*
+ * As with std::string, an inline string converts to and from a string value unchanged.
+ * A conversion from a string too long for the capacity fails, producing the truncated string.
+ */
+template <unsigned int N>
+class DataConverter<InlineString<N> > {
+	friend struct Data;
+
+	static InlineString<N> convertFromStringValue(const std::string &val) {
+		return InlineString<N>(val);
+	}
+
+public:
+	std::string convertToStringValue(const InlineString<N> &val) {
+		return val.str();
+	}
+
+	bool conversionFailed;
+
+	InlineString<N> convertFromString(const std::string &val) {
+		InlineString<N> result;
+		conversionFailed = !result.assign(val);
+		return result;
+	}
+};
+
+/*
+ * Inline bytes convert to and from a string holding the same bytes, just as byte_vector_wrapper accepts char arrays.
+ */
+template <unsigned int N>
+class DataConverter<InlineBytes<N> > {
+	friend struct Data;
+
+	static InlineBytes<N> convertFromStringValue(const std::string &val) {
+		return InlineBytes<N>((const INT_8 *) val.data(), val.length());
+	}
+
+public:
+	std::string convertToStringValue(const InlineBytes<N> &val) {
+		return std::string((const char *) val.data(), val.size());
+	}
+
+	bool conversionFailed;
+
+	InlineBytes<N> convertFromString(const std::string &val) {
+		InlineBytes<N> result;
+		conversionFailed = !result.assign((const INT_8 *) val.data(), val.length());
+		return result;
+	}
+};
+
+} /* namespace hpqueue */
+
+#endif /* BASE_INLINEBUFFER_H_ */
@@ -18,6 +18,20 @@ class Consumer {
 protected:
 	virtual void handle(QueueEntryBase &entry) = 0;
 
+	/*
+	 * Handles a batch of entries removed from consecutive queue slots.
+	 * Consumers that can amortize work across entries may override this, otherwise each entry is handled in turn.
+	 * Slots whose data could not be stored hold the null entry, which is skipped.
+	 */
+	virtual void handleBatch(QueueEntryBase *entries[], unsigned int count) {
+		for(unsigned int i = 0; i < count; i++) {
+			QueueEntryBase &entry = *entries[i];
+			if(!entry.isNull()) {
+				handle(entry);
+			}
+		}
+	}
+
 	Consumer() {}
 
 	virtual ~Consumer() {}
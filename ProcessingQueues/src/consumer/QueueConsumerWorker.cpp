@@ -6,6 +6,7 @@
  */
 
 #include <unistd.h>
+#include <algorithm>
 
 #include "QueueConsumerWorker.h"
 
@@ -22,20 +23,69 @@ void QueueConsumerWorker::finalize() {
 	updateStats();
 }
 
+unsigned int QueueConsumerWorker::getBatchSize() {
+	if(maxBatchSize == 1) {
+		return 1;
+	}
+	int depth = queueAccess.queue->getNumElements();
+	if(numWorkers > 1) {
+		depth /= numWorkers;
+	}
+	if(depth <= 1) {
+		return 1;
+	}
+	return std::min((unsigned int) depth, maxBatchSize);
+}
+
 bool QueueConsumerWorker::doWork() {
-	QueueEntryBase &entry = queueAccess.remove();
-	if(!entry.isNull()) {
-		queueAccess.incrementRemovedCount();
-		consumer->handle(entry);
-		return true;
+	bool result = handleEntries();
+
+	/*
+	 * Some queues need to be told the entries have been handled before their slots can be written again.
+	 * Releasing them here, rather than at the next removal, also means a paused worker holds no slots while the queue is resized.
+	 */
+	queueAccess.release();
+	return result;
+}
+
+bool QueueConsumerWorker::handleEntries() {
+	if(maxBatchSize == 1) {
+		QueueEntryBase &entry = queueAccess.remove();
+		if(!entry.isNull()) {
+			queueAccess.incrementRemovedCount();
+			consumer->handle(entry);
+			return true;
+		}
+		return false;
+	}
+	QueueEntryBase **entries = &batch[0];
+	unsigned int count = queueAccess.removeBatch(entries, getBatchSize());
+	if(count == 0) {
+		return false;
+	}
+	unsigned int removed = 0;
+	for(unsigned int i = 0; i < count; i++) {
+		if(!entries[i]->isNull()) {
+			removed++;
+		}
 	}
-	return false;
+	if(removed == 0) {
+		/* as with a single removal, slots holding only the null entry are not work */
+		return false;
+	}
+	queueAccess.incrementRemovedCount(removed);
+	consumer->handleBatch(entries, count);
+	return true;
 }
 
 bool QueueConsumerWorker::isWork() {
 	return !queueAccess.isEmpty();
 }
 
+bool QueueConsumerWorker::isWorkReady() {
+	return queueAccess.syncQueue->hasWorkFor(queueAccess.readerIndex);
+}
+
 void QueueConsumerWorker::setDebug(bool debug) {
 	Worker::setDebug(debug);
 	queueAccess.queue->setDebug(debug);
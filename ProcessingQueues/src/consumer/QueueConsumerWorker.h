@@ -8,6 +8,8 @@
 #ifndef CONSUMINGWORKER_H_
 #define CONSUMINGWORKER_H_
 
+#include <vector>
+
 #include "Worker.h"
 #include "Consumer.h"
 #include "queue/SyncQueue.h"
@@ -40,6 +42,14 @@ class QueueConsumerWorker: public Worker {
 			return queue->remove(readerIndex);
 		}
 
+		unsigned int removeBatch(QueueEntryBase *entries[], unsigned int maxCount) {
+			return queue->removeBatch(readerIndex, entries, maxCount);
+		}
+
+		void release() {
+			queue->release(readerIndex);
+		}
+
 		virtual void updateStats() {
 			/* we do an atomic swap so that calls to incrementRemovedCount require no synchronization */
 			unsigned int *ptr = &removedCount;
@@ -51,6 +61,10 @@ class QueueConsumerWorker: public Worker {
 		virtual void incrementRemovedCount() {
 			removedCount++;
 		}
+
+		virtual void incrementRemovedCount(unsigned int increment) {
+			removedCount += increment;
+		}
 	};
 
 	/**
@@ -75,10 +89,30 @@ class QueueConsumerWorker: public Worker {
 	/* the number of workers, including this one */
 	int numWorkers;
 
+	/* the largest number of entries removed at once, which is 1 when entries are removed one at a time */
+	unsigned int maxBatchSize;
+
+	/* holds the entries of the current batch */
+	std::vector<QueueEntryBase *> batch;
+
+	/*
+	 * Chooses how many entries to remove at once from the depth of the queue.
+	 * The depth is shared among the workers, so that a shallow queue is spread across them in small batches for low latency,
+	 * while a backed-up queue is drained in large batches for throughput.
+	 */
+	unsigned int getBatchSize();
+
+	/*
+	 * Removes entries from the queue and hands them to the consumer, returning false if there were none.
+	 */
+	bool handleEntries();
+
 	bool doWork();
 
 	bool isWork();
 
+	bool isWorkReady();
+
 	void init();
 
 	void finalize();
@@ -90,12 +124,15 @@ public:
 			SyncQueue *sharedQueue,
 			int numWorkers,
 			Consumer *consumer,
-			pthreadWrapper::Mutex *stdoutLock) :
+			pthreadWrapper::Mutex *stdoutLock,
+			unsigned int maxBatchSize = 1) :
 		Worker(identifier, NULL),
 		stdoutLock(stdoutLock),
 		queueAccess(sharedQueue, identifier),
 		consumer(consumer),
-		numWorkers(numWorkers) {}
+		numWorkers(numWorkers),
+		maxBatchSize(maxBatchSize ? maxBatchSize : 1),
+		batch(this->maxBatchSize) {}
 
 	virtual ~QueueConsumerWorker() {}
 
@@ -5,6 +5,7 @@
  *      Author: sfoley
  */
 
+#include <sched.h>
 #include <cstdio>
 #include <vector>
 #include <string>
@@ -33,7 +34,9 @@ bool QueueProcessor::start() {
 			workerLock.acquire();
 			for(unsigned int i=0; i<numWorkers; i++) {
 				WorkerCache &worker = workers[i];
-				worker.processingWorker->start();
+				if(!worker.processingWorker->start()) {
+					result = false;
+				}
 			}
 			workerLock.release();
 		} else {
@@ -47,10 +50,25 @@ bool QueueProcessor::start() {
 						&sharedQueue,
 						numWorkers,
 						workers[i].consumer,
-						&stdoutLock);
+						&stdoutLock,
+						maxRemoveBatchSize);
 				workers[i].processingWorker = processingWorker;
 				processingWorker->setDebug(this->debug);
-				processingWorker->start();
+				pthreadWrapper::ThreadConfig threadConfig = workers[i].threadConfig;
+				if(threadConfig.cpus.isEmpty()) {
+					threadConfig.cpus = workerCpus;
+				}
+				processingWorker->setThreadConfig(threadConfig);
+				processingWorker->setWaitStrategy(waitStrategy);
+				processingWorker->setAwaitingWorkCount(&awaitingWorkers);
+				processingWorker->setAwaitingWorkHint(&awaitingWorkerHint);
+				wakeableWorkers[i].store(processingWorker);
+				if(anyWorkerCanRemove && doorbell.isEnabled()) {
+					processingWorker->setDoorbell(&doorbell);
+				}
+				if(!processingWorker->start()) {
+					result = false;
+				}
 			}
 			workerLock.release();
 		}
@@ -92,6 +110,14 @@ void QueueProcessor::stop() {
 			processingWorker->stop();
 		}
 
+		/* no thread adding entries can find the workers once the threads scanning for them are done, see wakeWorkers */
+		for(unsigned int i=0; i<numWorkers; i++) {
+			wakeableWorkers[i].store(NULL);
+		}
+		while(activeWakers.load() > 0) {
+			sched_yield();
+		}
+
 		/* wait for the workers to stop */
 		for (it = workers.begin(); it != workers.end(); it++) {
 			WorkerCache &worker = *it;
@@ -110,22 +136,53 @@ void QueueProcessor::stop() {
 }
 
 void QueueProcessor::broadcast() {
-	workerLock.acquire();
-	for (vector<WorkerCache>::iterator it = workers.begin(); it != workers.end(); it++) {
-		WorkerCache &worker = *it;
-		Worker *processingWorker = worker.processingWorker;
-		if(processingWorker) {
-			processingWorker->signal();
+	if(hasAwaitingWorkers()) {
+		unsigned int woken = wakeWorkers(numWorkers);
+		if(woken) {
+			sharedQueue.getStats().incrementWakeupCount(woken);
+		}
+	}
+}
+
+void QueueProcessor::wakeWorker(unsigned int count) {
+	if(!hasAwaitingWorkers()) {
+		return;
+	}
+	bool coalesced = anyWorkerCanRemove && doorbell.isEnabled();
+	unsigned int emptyCount = 0;
+	if(coalesced && !doorbell.shouldRing(emptyCount)) {
+		sharedQueue.getStats().incrementSuppressedWakeupCount();
+		return;
+	}
+	unsigned int woken = wakeWorkers(coalesced ? 1 : count);
+	if(woken) {
+		if(coalesced) {
+			doorbell.ring(emptyCount);
 		}
-		//TODO can we call isWork() on the worker just before we wake it up?
-		//if no work, do we need to signal all further workers?
+		sharedQueue.getStats().incrementWakeupCount(woken);
+	}
+}
 
-		//However, keep in mind that for the multi-reader queue, just because one doesn't have work that doesn't mean they all don't
-		//in fact, since they form a queue (SynReaderList) it would be best to wake them up in the queue order
+bool QueueProcessor::hasAwaitingWorkers() {
+	/* orders the entries added before the check for waiting workers, pairing with the fence in Worker::startAwaitingWork */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	return awaitingWorkers.load(std::memory_order_relaxed) > 0;
+}
 
-		//This change is not trivial... we would need to take a long look
+unsigned int QueueProcessor::wakeWorkers(unsigned int maxCount) {
+	unsigned int count = 0;
+	/* orders the count before loading the workers, pairing with stop, which removes the workers before checking the count */
+	activeWakers.fetch_add(1);
+	unsigned int first = awaitingWorkerHint.load(std::memory_order_relaxed);
+	for(unsigned int i=0; i<numWorkers && count < maxCount; i++) {
+		unsigned int index = (first + i) % numWorkers;
+		Worker *processingWorker = wakeableWorkers[index].load();
+		if(processingWorker && processingWorker->wakeIfWork()) {
+			count++;
+		}
 	}
-	workerLock.release();
+	activeWakers.fetch_sub(1, std::memory_order_release);
+	return count;
 }
 
 void QueueProcessor::terminate() {
@@ -234,6 +291,22 @@ void QueueProcessor::setDebug(bool debug) {
 	workerLock.release();
 }
 
+void QueueProcessor::setThreadConfig(const pthreadWrapper::ThreadConfig &config) {
+	workerLock.acquire();
+	for (vector<WorkerCache>::iterator it = workers.begin(); it != workers.end(); it++) {
+		it->threadConfig = config;
+	}
+	workerLock.release();
+}
+
+void QueueProcessor::setThreadConfig(unsigned int workerIndex, const pthreadWrapper::ThreadConfig &config) {
+	workerLock.acquire();
+	if(workerIndex < workers.size()) {
+		workers[workerIndex].threadConfig = config;
+	}
+	workerLock.release();
+}
+
 }
 
 
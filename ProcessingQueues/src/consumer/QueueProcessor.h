@@ -8,11 +8,13 @@
 #ifndef QUEUEPROCESSOR_H_
 #define QUEUEPROCESSOR_H_
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <list>
 #include <stdexcept>
 
+#include "WakeupDoorbell.h"
 #include "Worker.h"
 #include "Consumer.h"
 #include "queue/SyncQueue.h"
@@ -58,29 +60,106 @@ protected:
 		 */
 		Consumer *consumer;
 
+		/*
+		 * How the worker's thread is created, see setThreadConfig.
+		 */
+		pthreadWrapper::ThreadConfig threadConfig;
+
 		WorkerCache(Consumer *consumer): processingWorker(NULL), consumer(consumer) {}
 	};
 
 	std::vector<WorkerCache> workers;
 	unsigned int nestedPauseCounter;
 	unsigned int queueSize;
+	unsigned int maxRemoveBatchSize;
+
+	/*
+	 * The CPUs to which the workers are pinned, or empty if they are not pinned, see QueueOptions::numaNode.
+	 */
+	pthreadWrapper::CpuSet workerCpus;
+
+	pthreadWrapper::WaitStrategy waitStrategy;
+
+	/*
+	 * The number of workers waiting for work, see Worker::setAwaitingWorkCount.
+	 */
+	std::atomic<unsigned int> awaitingWorkers;
+
+	/*
+	 * The started workers, indexed as in workers, which threads adding entries scan for a waiting worker without
+	 * acquiring workerLock, see wakeWorkers.  A worker is removed before it is deleted, see activeWakers.
+	 */
+	std::vector<std::atomic<Worker *> > wakeableWorkers;
+
+	/*
+	 * The identifier of the worker that most recently started waiting for work, where the scan for a waiting worker starts,
+	 * see Worker::setAwaitingWorkHint.
+	 */
+	std::atomic<unsigned int> awaitingWorkerHint;
+
+	/*
+	 * The number of threads scanning wakeableWorkers, which must drop to zero before a removed worker is deleted.
+	 */
+	std::atomic<unsigned int> activeWakers;
+
+	/*
+	 * Whether a waiting worker can remove any entry in the queue, as when readers claim slots with an atomic ticket.
+	 * Otherwise each waiting worker has been assigned a slot of its own by the SyncReaderList, and only the worker
+	 * assigned a slot can remove the entry added to it.
+	 */
+	bool anyWorkerCanRemove;
+
+	/*
+	 * Coalesces the wakeups of waiting workers, when enabled by the queue options and any worker can remove any entry.
+	 */
+	WakeupDoorbell doorbell;
+
 	SyncQueue sharedQueue;
 	bool debug;
 
+	/*
+	 * Returns whether any worker is waiting for work, after entries have been added.
+	 */
+	bool hasAwaitingWorkers();
+
+	/*
+	 * Signals the workers waiting for work that have work to do, stopping after the given number of workers,
+	 * and returns the number signalled.  No lock is acquired: the scan starts at the worker that most recently started waiting,
+	 * and each worker is claimed with an atomic flag, see Worker::wakeIfWork.
+	 */
+	unsigned int wakeWorkers(unsigned int maxCount);
+
+	static pthreadWrapper::CpuSet getWorkerCpus(const QueueOptions &options) {
+		if(options.workerCpus.isEmpty() && options.numaNode >= 0) {
+			return pthreadWrapper::CpuSet::getNumaNodeCpus(options.numaNode);
+		}
+		return options.workerCpus;
+	}
+
 public:
 
 	QueueProcessor(
 			ProcessingQueueDataArray *dataEntries,
 			unsigned int numWorkers,
 			const std::vector<Consumer *> &workerConsumers,
-			unsigned int queueSize) :
+			unsigned int queueSize,
+			const QueueOptions &options = QueueOptions()) :
 				numWorkers(numWorkers),
 				isRunningFlag(false),
 				isPausedFlag(false),
 				isTerminatedFlag(false),
 				nestedPauseCounter(0),
 				queueSize(queueSize),
-				sharedQueue(queueSize, dataEntries, &stdoutLock),
+				maxRemoveBatchSize(options.maxRemoveBatchSize),
+				workerCpus(getWorkerCpus(options)),
+				waitStrategy(options.waitStrategy),
+				awaitingWorkers(0),
+				wakeableWorkers(numWorkers),
+				awaitingWorkerHint(0),
+				activeWakers(0),
+				anyWorkerCanRemove(options.lockFreeReaders || options.onlineResize || options.segmentSize > 0),
+				doorbell(options.doorbellMaxAdds, options.doorbellMaxMicros),
+				sharedQueue(queueSize, dataEntries, &stdoutLock, true, options),
 				debug(false) {
 		if(numWorkers > 0 && workerConsumers.size() < 1) {
 			std::cout << "no consumers provided" << endl;
@@ -95,6 +174,7 @@ public:
 
 	/*
 	 * start processing the first time, or restart if paused
+	 * returns false if the thread of a worker could not be created, calling start again tries again for those workers
 	 */
 	bool start();
 
@@ -146,14 +226,40 @@ public:
 	}
 
 	/*
-	 * signals all threads that there is work to be done.
+	 * signals all threads waiting for work that there is work to be done.
 	 */
 	void broadcast();
 
+	/*
+	 * Signals a worker waiting for work that there is work to be done, after an entry is added.
+	 *
+	 * No worker is signalled when none is waiting, since the running workers will find the entry.
+	 * When workers are waiting, the first waiting worker found with work is signalled, and no lock is acquired.
+	 * For a queue whose workers each wait on a slot assigned by the SyncReaderList, only the worker waiting on the slot
+	 * that was added has work.  Writers publish their slots in order, one add at a time, so each add has one worker to signal.
+	 * After a batch of count entries is added, up to count workers with work are signalled.
+	 *
+	 * With a doorbell, a single worker is signalled, and only as the doorbell decides, see QueueOptions::doorbellMaxAdds.
+	 */
+	void wakeWorker(unsigned int count = 1);
+
 	void writeQueueStats(std::ostream& out);
 
 	void setDebug(bool debug);
 
+	/*
+	 * Sets how the threads of all the workers are created: their CPUs, names, stack size and scheduling, see ThreadConfig.
+	 * Workers with no CPUs in the configuration are pinned as given by the queue options, see QueueOptions::workerCpus,
+	 * and workers with no name are named after the worker.
+	 * Takes effect for workers started from now on, so it is called before start.
+	 */
+	void setThreadConfig(const pthreadWrapper::ThreadConfig &config);
+
+	/*
+	 * As above, for the worker with the given index only, such as to pin each worker to a CPU of its own.
+	 */
+	void setThreadConfig(unsigned int workerIndex, const pthreadWrapper::ThreadConfig &config);
+
 };
 
 }
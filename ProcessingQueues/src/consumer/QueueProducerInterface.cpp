@@ -5,31 +5,81 @@
  *      Author: sfoley
  */
 
+#include <algorithm>
+
 #include "QueueProducerInterface.h"
 
 namespace hpqueue {
 
 struct ProcessorQueueAdder {
 	SyncWriterQueue &queue;
-	QueueEntryBase &entry;
 
-	ProcessorQueueAdder(SyncWriterQueue &queue, QueueEntryBase &entry) : queue(queue), entry(entry) {}
+	ProcessorQueueAdder(SyncWriterQueue &queue) : queue(queue) {}
 
-	virtual int add() {
-		return queue.add(entry);
-	}
+	virtual int add() = 0;
 
-	void resize() {
+	virtual void resize() {
 		queue.resize(queue.getNewQueueSize());
 	}
 
+	/*
+	 * Returns true when the queue cannot be made larger, either because it is at its max size,
+	 * or because it grows by itself and has reached its max size.
+	 */
 	bool isMaxSize() {
-		return queue.getCurrentSize() >= MAX_QUEUE_SIZE(queue.getEntrySize());
+		return !queue.isResizable();
 	}
 
 	virtual ~ProcessorQueueAdder(){}
 };
 
+struct ProcessorQueueEntryAdder : public ProcessorQueueAdder {
+	QueueEntryWriter &writer;
+
+	ProcessorQueueEntryAdder(SyncWriterQueue &queue, QueueEntryWriter &writer) : ProcessorQueueAdder(queue), writer(writer) {}
+
+	int add() {
+		return queue.add(writer);
+	}
+};
+
+struct ProcessorQueueBatchAdder : public ProcessorQueueAdder {
+	QueueEntryBase **entries;
+	unsigned int count;
+
+	ProcessorQueueBatchAdder(SyncWriterQueue &queue, QueueEntryBase *entries[], unsigned int count) :
+		ProcessorQueueAdder(queue), entries(entries), count(count) {}
+
+	int add() {
+		return queue.addBatch(entries, count);
+	}
+
+	/*
+	 * Grow the queue in a single step to a size that fits the whole batch.
+	 */
+	void resize() {
+		queue.resize(queue.getNewQueueSize(queue.getNumElements() + count + 1));
+	}
+};
+
+struct ProcessorQueueReserver : public ProcessorQueueAdder {
+	SlotSelector &selector;
+	QueueReservation &reservation;
+	ResizeControls &controls;
+
+	ProcessorQueueReserver(SyncWriterQueue &queue, SlotSelector &selector, QueueReservation &reservation, ResizeControls &controls) :
+		ProcessorQueueAdder(queue), selector(selector), reservation(reservation), controls(controls) {}
+
+	int add() {
+		int index = queue.reserve(selector, reservation);
+		if(index >= 0) {
+			/* no resize can move the slot until it is committed */
+			controls.addReservation();
+		}
+		return index;
+	}
+};
+
 void QueueProducerInterface::resumeThreadsForResize(ResizeControls &controls) {
 	resume(); //resume workers
 	controls.resumeAdders();
@@ -48,10 +98,70 @@ void QueueProducerInterface::pauseThreadsForResize(ResizeControls &controls) {
 }
 
 void QueueProducerInterface::add(QueueEntryBase &entry) {
-	ProcessorQueueAdder adder(sharedQueue, entry);
+	QueueEntryCopier writer(entry);
+	add(writer);
+}
+
+void QueueProducerInterface::add(QueueEntryBase &&entry) {
+	QueueEntryMover writer(entry);
+	add(writer);
+}
+
+void QueueProducerInterface::add(QueueEntryWriter &writer) {
+	ProcessorQueueEntryAdder adder(sharedQueue, writer);
 	int index = addToQueue(adder, resizeControls);
-	if(index >= 0) {
-		broadcast();
+	if(index >= 0 || index == QueueConstants::CANNOT_ADD) {
+		/* an entry that cannot be added may leave a null entry in a claimed slot, which the reader assigned the slot must pass */
+		wakeWorker();
+	}
+}
+
+QueueEntryBase *QueueProducerInterface::reserve(QueueEntryBase &entryType, QueueReservation &reservation) {
+	EntrySlotSelector selector(entryType);
+	return reserve(selector, reservation);
+}
+
+QueueEntryBase *QueueProducerInterface::reserve(SlotSelector &selector, QueueReservation &reservation) {
+	ProcessorQueueReserver reserver(sharedQueue, selector, reservation, resizeControls);
+	if(addToQueue(reserver, resizeControls) < 0) {
+		return NULL;
+	}
+	return reservation.entry;
+}
+
+void QueueProducerInterface::commit(QueueReservation &reservation) {
+	sharedQueue.commit(reservation);
+	resizeControls.removeReservation();
+	wakeWorker();
+}
+
+void QueueProducerInterface::abort(QueueReservation &reservation) {
+	sharedQueue.abort(reservation);
+	resizeControls.removeReservation();
+	/* the slot may be left holding the null entry, which the reader assigned the slot must pass */
+	wakeWorker();
+}
+
+void QueueProducerInterface::addBatch(QueueEntryBase *entries[], unsigned int count) {
+	/*
+	 * A batch must fit into the queue at its max size, with room to spare for the consumers to catch up,
+	 * otherwise we break it up.
+	 */
+	unsigned int maxBatchSize = std::max(sharedQueue.getMaxQueueSize() / 2, 1U);
+	while(count > 0) {
+		unsigned int batchSize = std::min(count, maxBatchSize);
+		ProcessorQueueBatchAdder adder(sharedQueue, entries, batchSize);
+		if(addToQueue(adder, resizeControls) >= 0) {
+			wakeWorker(batchSize);
+		}
+		entries += batchSize;
+		count -= batchSize;
+	}
+}
+
+void QueueProducerInterface::addBatch(std::vector<QueueEntryBase *> &entries) {
+	if(!entries.empty()) {
+		addBatch(&entries[0], entries.size());
 	}
 }
 
@@ -67,12 +177,48 @@ int QueueProducerInterface::addToQueue(ProcessorQueueAdder &adder, ResizeControl
 			) {
 		pauseThreadsForResize(controls); /* ensure no threads are adding and also pause worker threads */
 		adder.resize(); /* make the queue bigger */
+		if(shrinkPolicy.isEnabled()) {
+			/*
+			 * The queue stays at its new size for at least a full shrink period.
+			 * This must happen before resuming, since a shrinking thread holds the shrink lock while waiting for adders to pause.
+			 */
+			shrinkLock.acquire();
+			shrinkPolicy.reset();
+			shrinkLock.release();
+		}
 		resumeThreadsForResize(controls); /* end the resize by resetting the resize flag and resume workers */
 		index = adder.add(); /* try again */
 	}
 	return index;
 }
 
+void QueueProducerInterface::ShrinkTimer::run() {
+	while(!isStoppedFlag.load()) {
+		int key = stopSignal.prepareWait();
+		if(isStoppedFlag.load()) {
+			stopSignal.cancelWait();
+			break;
+		}
+		if(!stopSignal.wait(key, intervalMicros)) {
+			processor.checkShrink();
+		}
+	}
+}
+
+void QueueProducerInterface::checkShrink() {
+	if(isTerminatedFlag || !shrinkLock.tryAcquire() /* the queue is growing */) {
+		return;
+	}
+	unsigned int newSize = shrinkPolicy.getShrunkSize(sharedQueue.getNumElements(), sharedQueue.getCurrentSize());
+	if(newSize > 0 && resizeControls.startResize()) {
+		pauseThreadsForResize(resizeControls);
+		sharedQueue.resize(newSize); /* the queue is left as it is if the entries in use do not fit */
+		resume(); //resume workers
+		resizeControls.endResize();
+	}
+	shrinkLock.release();
+}
+
 /**
  * Continue trying to add when the queue cannot be resized.
  */
@@ -8,11 +8,18 @@
 #ifndef QUEUEPRODUCERINTERFACE_H_
 #define QUEUEPRODUCERINTERFACE_H_
 
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <utility>
 #include <vector>
 
 #include "QueueConsumerWorker.h"
 #include "QueueProcessor.h"
 #include "queue/ResizeControls.h"
+#include "queue/ShrinkPolicy.h"
+#include "threading/EventCount.h"
+#include "threading/Thread.h"
 
 namespace hpqueue {
 
@@ -37,6 +44,70 @@ class QueueProducerInterface : public QueueProcessor {
 
 	static bool checkResizable(int &index, ProcessorQueueAdder &adder);
 
+	/*
+	 * Decides when the queue shrinks back down after growing, see QueueOptions.
+	 * Only the thread holding shrinkLock uses the policy.
+	 */
+	ShrinkPolicy shrinkPolicy;
+
+	pthreadWrapper::Mutex shrinkLock;
+
+	/*
+	 * Samples the occupancy of the queue for the shrink policy from a thread of its own, a few times each shrink period,
+	 * so that a queue shrinks once it goes quiet, even when nothing more is added to it.
+	 */
+	class ShrinkTimer : public pthreadWrapper::Runnable {
+		QueueProducerInterface &processor;
+
+		unsigned int intervalMicros;
+
+		std::atomic<bool> isStoppedFlag;
+
+		pthreadWrapper::EventCount stopSignal;
+
+		pthreadWrapper::Thread thread;
+
+		void run();
+
+	public:
+		ShrinkTimer(QueueProducerInterface &processor, unsigned int periodMillis) :
+			processor(processor),
+			intervalMicros(std::max(periodMillis * 1000 / SHRINK_CHECKS_PER_PERIOD, 1000U)),
+			isStoppedFlag(false),
+			thread(this) {
+			thread.setName("queue shrink");
+		}
+
+		bool start() {
+			return thread.start();
+		}
+
+		/*
+		 * Stops the timer and waits for its thread to finish.
+		 */
+		void stop() {
+			isStoppedFlag.store(true);
+			stopSignal.notify();
+			thread.join();
+		}
+	};
+
+	/* the number of times in each shrink period that the timer samples the occupancy */
+	static const unsigned int SHRINK_CHECKS_PER_PERIOD = 4;
+
+	ShrinkTimer shrinkTimer;
+
+	/*
+	 * Called by the shrink timer, shrinks the queue if the policy says so.
+	 * The producers and consumers are paused while the queue shrinks, just as when it grows.
+	 */
+	void checkShrink();
+
+	static unsigned int getShrinkLowWatermark(const QueueOptions &options) {
+		/* a queue that resizes online never pauses its producers and consumers, so it does not shrink */
+		return (options.onlineResize || options.segmentSize > 0) ? 0 : options.shrinkLowWatermark;
+	}
+
 public:
 	/*
 	 * Functor is a function or type which takes QueueEntryBase& as an argument.
@@ -47,17 +118,105 @@ public:
 	 *
 	 * If there are fewer functors than workers, the last functor will be shared amongst the remaining workers.
 	 * So you can specify just a single functor if desired.
+	 *
+	 * The options select the queue algorithms, see QueueOptions.
 	 */
 	QueueProducerInterface(
 			ProcessingQueueDataArray *dataEntries,
 			unsigned int numWorkers,
 			const std::vector<Consumer *> &workerConsumers,
-			unsigned int queueSize): QueueProcessor(dataEntries, numWorkers, workerConsumers, queueSize) {}
+			unsigned int queueSize,
+			const QueueOptions &options = QueueOptions()):
+		QueueProcessor(dataEntries, numWorkers, workerConsumers, queueSize, options),
+		shrinkPolicy(getShrinkLowWatermark(options), options.shrinkPeriodMillis, sharedQueue.getCurrentSize()),
+		shrinkTimer(*this, options.shrinkPeriodMillis) {
+		if(shrinkPolicy.isEnabled()) {
+			shrinkTimer.start();
+		}
+	}
 
-	virtual ~QueueProducerInterface() {}
+	virtual ~QueueProducerInterface() {
+		if(shrinkPolicy.isEnabled()) {
+			shrinkTimer.stop();
+		}
+	}
 
 	void add(QueueEntryBase &entry);
 
+	/*
+	 * Adds the entry by moving its data into the queue slot rather than copying it, see QueueEntryBase::moveFrom.
+	 * Afterwards the entry is valid but its contents are unspecified.
+	 */
+	void add(QueueEntryBase &&entry);
+
+	/*
+	 * Adds an entry of type T constructed with the given arguments directly in the queue slot,
+	 * rather than constructing the entry and then copying it into the slot.
+	 * The slot is selected by the tag of T, so the queue's data array must store entries by type tag,
+	 * as SingleTypeDataArray and MultiTypeDataArray do, see ProcessingQueueDataArray::isCompatibleType.
+	 */
+	template <typename T, typename... Args>
+	void emplace(Args&&... args) {
+		auto construct = [&](void *address) {
+			return new (address) T(std::forward<Args>(args)...);
+		};
+		QueueEntryEmplacer<T, decltype(construct)> writer(construct);
+		add(writer);
+	}
+
+	/*
+	 * Adds an entry populated by the writer, see QueueEntryWriter.
+	 */
+	void add(QueueEntryWriter &writer);
+
+	/*
+	 * Reserves a queue slot for an entry of the same type as entryType, returning the entry in the slot so that
+	 * it can be populated in place, such as by decoding a message directly into it, or NULL if the entry cannot be queued.
+	 * The entry becomes visible to the consumers when the reservation is committed.
+	 *
+	 * Every reservation must be committed or aborted, and promptly: other producers cannot commit before it, and the queue cannot resize.
+	 * The same thread must not add to this processor while holding a reservation.
+	 */
+	QueueEntryBase *reserve(QueueEntryBase &entryType, QueueReservation &reservation);
+
+	/*
+	 * Reserves a queue slot chosen by the selector, see reserve above.
+	 */
+	QueueEntryBase *reserve(SlotSelector &selector, QueueReservation &reservation);
+
+	/*
+	 * Reserves a queue slot for an entry of type T, see reserve above.
+	 * As with emplace, the slot is selected by the tag of T, so the queue's data array must store entries by type tag.
+	 */
+	template <typename T>
+	T *reserve(QueueReservation &reservation) {
+		TaggedSlotSelector<T> selector;
+		QueueEntryBase *entry = reserve(selector, reservation);
+		if(!entry) {
+			return NULL;
+		}
+		T *result = QueueEntryBase::cast<T>(*entry);
+		if(!result) {
+			/* the queue stores the entry in a slot of a different type */
+			abort(reservation);
+		}
+		return result;
+	}
+
+	void commit(QueueReservation &reservation);
+
+	void abort(QueueReservation &reservation);
+
+	/*
+	 * Adds a batch of entries to the queue, waking the consumers once for the whole batch.
+	 *
+	 * The batch is added to consecutive queue slots all at once, so a batch causes at most one queue resize.
+	 * Batches larger than half the max queue size are broken up.
+	 */
+	void addBatch(QueueEntryBase *entries[], unsigned int count);
+
+	void addBatch(std::vector<QueueEntryBase *> &entries);
+
 	void writeQueueStats(std::ostream& out) {
 		QueueProcessor::writeQueueStats(out);
 	}
@@ -0,0 +1,54 @@
+/*
+ * TypedConsumer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CONSUMER_TYPEDCONSUMER_H_
+#define CONSUMER_TYPEDCONSUMER_H_
+
+#include "Consumer.h"
+
+namespace hpqueue {
+
+/**
+ * A consumer of a queue holding entries of the single type Entry, such as a queue using SingleTypeDataArray<Entry>.
+ *
+ * Handler is a functor type that takes Entry& as an argument.  Since the type of each entry is known at compile time,
+ * entries are passed to the handler without a dynamic_cast, and the handler is called directly so that it can be inlined.
+ * A batch of entries costs a single virtual call.
+ */
+template <class Entry, class Handler>
+class TypedConsumer : public Consumer {
+	Handler handler;
+
+protected:
+	void handle(QueueEntryBase &entry) {
+		handler(static_cast<Entry &>(entry));
+	}
+
+	void handleBatch(QueueEntryBase *entries[], unsigned int count) {
+		for(unsigned int i = 0; i < count; i++) {
+			/* slots whose data could not be stored hold the null entry, which is not an Entry */
+			if(entries[i] != &QueueEntryBase::nullEntry) {
+				Entry &entry = static_cast<Entry &>(*entries[i]);
+				if(!entry.Entry::isNull()) {
+					handler(entry);
+				}
+			}
+		}
+	}
+
+public:
+	TypedConsumer(const Handler &handler = Handler()) : handler(handler) {}
+
+	virtual ~TypedConsumer() {}
+
+	Handler &getHandler() {
+		return handler;
+	}
+};
+
+} /* namespace hpqueue */
+
+#endif /* CONSUMER_TYPEDCONSUMER_H_ */
@@ -0,0 +1,133 @@
+/*
+ * TypedQueueProcessor.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CONSUMER_TYPEDQUEUEPROCESSOR_H_
+#define CONSUMER_TYPEDQUEUEPROCESSOR_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "QueueProducerInterface.h"
+#include "TypedConsumer.h"
+#include "queue/SingleTypeDataArray.h"
+
+namespace hpqueue {
+
+/*
+ * The data array and consumers of a TypedQueueProcessor,
+ * held in a base class so that they are constructed before the processor that uses them, and destroyed after it.
+ */
+template <class Entry, class Handler>
+class TypedProcessorStorage {
+protected:
+	SingleTypeDataArray<Entry> dataArray;
+
+	std::vector<TypedConsumer<Entry, Handler> > typedConsumers;
+
+	std::vector<Consumer *> consumers;
+
+	TypedProcessorStorage(const std::vector<Handler> &handlers) : typedConsumers(handlers.begin(), handlers.end()) {
+		for(unsigned int i = 0; i < typedConsumers.size(); i++) {
+			consumers.push_back(&typedConsumers[i]);
+		}
+	}
+};
+
+/**
+ * A queue processor for entries of the single type Entry, which are stored by value in the queue slots.
+ *
+ * The queue uses the same index, reader list and resize algorithms as QueueProducerInterface, selected with QueueOptions.
+ * But since the type of every entry is known at compile time, no dynamic_cast is needed to find the slot for an entry,
+ * to copy an entry into its slot, or to hand an entry to its handler.  The slot for an added entry is indexed directly
+ * in the processor's SingleTypeDataArray, see SingleTypeEntryCopier, entries are copied with the assignment operator
+ * of Entry rather than the virtual assignment operator of QueueEntryBase, and the handlers are called directly.
+ *
+ * Handler is a functor type that takes Entry& as an argument, see TypedConsumer.
+ * Each worker thread gets its own handler, and as with QueueProducerInterface, if there are fewer handlers than workers,
+ * the last handler is shared amongst the remaining workers.
+ */
+template <class Entry, class Handler>
+class TypedQueueProcessor : private TypedProcessorStorage<Entry, Handler>, private QueueProducerInterface {
+	typedef TypedProcessorStorage<Entry, Handler> Storage;
+
+public:
+	TypedQueueProcessor(
+			unsigned int numWorkers,
+			const std::vector<Handler> &handlers,
+			unsigned int queueSize,
+			const QueueOptions &options = QueueOptions()) :
+		Storage(handlers),
+		QueueProducerInterface(&this->dataArray, numWorkers, this->consumers, queueSize, options) {}
+
+	/*
+	 * Each worker gets its own copy of the handler.
+	 */
+	TypedQueueProcessor(
+			unsigned int numWorkers,
+			unsigned int queueSize,
+			const Handler &handler = Handler(),
+			const QueueOptions &options = QueueOptions()) :
+		Storage(std::vector<Handler>(numWorkers > 0 ? numWorkers : 1, handler)),
+		QueueProducerInterface(&this->dataArray, numWorkers, this->consumers, queueSize, options) {}
+
+	virtual ~TypedQueueProcessor() {}
+
+	void add(Entry &entry) {
+		SingleTypeEntryCopier<Entry> writer(entry, this->dataArray);
+		QueueProducerInterface::add(writer);
+	}
+
+	/*
+	 * Moves the entry into its queue slot, see QueueProducerInterface::add.
+	 */
+	void add(Entry &&entry) {
+		SingleTypeEntryMover<Entry> writer(entry, this->dataArray);
+		QueueProducerInterface::add(writer);
+	}
+
+	/*
+	 * Constructs an entry with the given arguments directly in its queue slot, see QueueProducerInterface::emplace.
+	 */
+	template <typename... Args>
+	void emplace(Args&&... args) {
+		QueueProducerInterface::emplace<Entry>(std::forward<Args>(args)...);
+	}
+
+	/*
+	 * Reserves a queue slot, returning the entry in the slot to be populated in place, see QueueProducerInterface::reserve.
+	 */
+	Entry *reserve(QueueReservation &reservation) {
+		TaggedSlotSelector<Entry> selector;
+		return static_cast<Entry *>(QueueProducerInterface::reserve(selector, reservation));
+	}
+
+	using QueueProducerInterface::commit;
+	using QueueProducerInterface::abort;
+
+	/*
+	 * Returns the handler used by the given worker.
+	 */
+	Handler &getHandler(unsigned int worker) {
+		return this->typedConsumers[std::min((size_t) worker, this->typedConsumers.size() - 1)].getHandler();
+	}
+
+	using QueueProducerInterface::start;
+	using QueueProducerInterface::pause;
+	using QueueProducerInterface::resume;
+	using QueueProducerInterface::stop;
+	using QueueProducerInterface::terminate;
+	using QueueProducerInterface::isTerminated;
+	using QueueProducerInterface::isRunning;
+	using QueueProducerInterface::isPaused;
+	using QueueProducerInterface::writeQueueStats;
+	using QueueProducerInterface::setDebug;
+	using QueueProducerInterface::setThreadConfig;
+};
+
+} /* namespace hpqueue */
+
+#endif /* CONSUMER_TYPEDQUEUEPROCESSOR_H_ */
@@ -0,0 +1,109 @@
+/*
+ * WakeupDoorbell.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef CONSUMER_WAKEUPDOORBELL_H_
+#define CONSUMER_WAKEUPDOORBELL_H_
+
+#include <sys/time.h>
+#include <atomic>
+
+#include "base/primitiveTypes.h"
+
+namespace hpqueue {
+
+/**
+ * Decides when adding an entry wakes a waiting consumer worker, so that a producer adding entries quickly
+ * to a queue with waiting workers does not wake a worker, at the cost of a system call, for every entry.
+ *
+ * The doorbell rings, waking a worker, when the queue becomes non-empty: that is, on the first add after a worker ran out
+ * of work.  The worker woken removes entries until the queue is empty again, so the adds that follow need not wake
+ * any other worker, and the doorbell stays quiet.  To bring in more workers when entries keep coming,
+ * the doorbell rings again once maxAdds entries have been added since it last rang, or once maxMicros have passed.
+ *
+ * This relies on any worker being able to remove any entry, so it does not apply to a queue whose waiting workers
+ * each wait on a slot of their own.
+ */
+class WakeupDoorbell {
+	/* the number of adds after which the doorbell rings again, or 0 for no limit */
+	unsigned int maxAdds;
+
+	/* the microseconds after which the doorbell rings again, or 0 for no limit */
+	unsigned int maxMicros;
+
+	/* counts the times a worker ran out of work */
+	std::atomic<unsigned int> emptyCount;
+
+	/*
+	 * The emptyCount read before the doorbell last rang.  Adds are quiet only while this matches emptyCount,
+	 * since the worker woken by that ring runs out of work, incrementing emptyCount, before it waits again.
+	 * A count rather than a flag means a ring that completes only after the worker it woke is already waiting again
+	 * leaves the doorbell ready to ring rather than silenced.
+	 */
+	std::atomic<unsigned int> rungCount;
+
+	/* the adds since the doorbell last rang */
+	std::atomic<unsigned int> quietAdds;
+
+	/* the time the doorbell last rang, when there is a limit on the microseconds between rings */
+	std::atomic<INT_64> rungMicros;
+
+	static INT_64 getCurrentMicros() {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		return ((INT_64) now.tv_sec) * 1000000 + now.tv_usec;
+	}
+
+public:
+	WakeupDoorbell(unsigned int maxAdds, unsigned int maxMicros) :
+		maxAdds(maxAdds),
+		maxMicros(maxMicros),
+		emptyCount(0),
+		rungCount(~0U),
+		quietAdds(0),
+		rungMicros(0) {}
+
+	bool isEnabled() {
+		return maxAdds > 0 || maxMicros > 0;
+	}
+
+	/*
+	 * Called by a worker that ran out of work, before its last check for work ahead of waiting,
+	 * so that the next add rings the doorbell.
+	 */
+	void rearm() {
+		emptyCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*
+	 * Called after an entry is added while workers are waiting, returns whether to wake a worker.
+	 * The count is to be passed to ring if a worker is woken.
+	 */
+	bool shouldRing(unsigned int &count) {
+		count = emptyCount.load(std::memory_order_relaxed);
+		if(rungCount.load(std::memory_order_relaxed) != count) {
+			return true;
+		}
+		if(maxAdds && quietAdds.fetch_add(1, std::memory_order_relaxed) + 1 >= maxAdds) {
+			return true;
+		}
+		return maxMicros && getCurrentMicros() - rungMicros.load(std::memory_order_relaxed) >= maxMicros;
+	}
+
+	/*
+	 * Called when the doorbell rang and a worker was woken, with the count from shouldRing.
+	 */
+	void ring(unsigned int count) {
+		quietAdds.store(0, std::memory_order_relaxed);
+		if(maxMicros) {
+			rungMicros.store(getCurrentMicros(), std::memory_order_relaxed);
+		}
+		rungCount.store(count, std::memory_order_relaxed);
+	}
+};
+
+}
+
+#endif /* CONSUMER_WAKEUPDOORBELL_H_ */
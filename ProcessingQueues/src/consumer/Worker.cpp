@@ -14,15 +14,24 @@ using namespace std;
 
 namespace hpqueue {
 
-void Worker::start() {
+bool Worker::start() {
+	bool result = true;
 	if(!isStartedFlag && !isTerminatedFlag) {
 		startLock.acquire();
 		if(!isStartedFlag && !isTerminatedFlag) {
 			isStartedFlag = true;
-			thread.start();
+			if(thread.getConfig().name.empty()) {
+				thread.setName(name);
+			}
+			if(!thread.start()) {
+				/* with no thread, nothing waits for the worker as if it were running, see signal and stop */
+				isStartedFlag = false;
+				result = false;
+			}
 		}
 		startLock.release();
 	}
+	return result;
 }
 
 void Worker::run() {
@@ -41,20 +50,11 @@ void Worker::run() {
 				hasPausedLock.release();
 			} else {
 				if(!doWork()) {
-					isWorkLock.acquire();
-					if(!isWork() && !isTerminatedFlag && !isPausedFlag) {
-						isWaitingFlag = true;
-						if(haveWorkJoiners) {
-							isWorkWaiting.broadcast();
-						}
-						if(timeoutSeconds) {
-							isWorkWaiting.wait(isWorkLock, timeoutSeconds * 1000000);
-						} else {
-							isWorkWaiting.wait(isWorkLock);
-						}
-						isWaitingFlag = false;
+					if(waitStrategy.type == pthreadWrapper::WaitStrategy::CONDITION_WAIT) {
+						waitOnCondition();
+					} else {
+						pollForWork();
 					}
-					isWorkLock.release();
 				}
 			}
 		} while(!isTerminatedFlag);
@@ -83,6 +83,97 @@ void Worker::run() {
 	signalDead();
 }
 
+void Worker::waitOnCondition() {
+	startAwaitingWork();
+	isWorkLock.acquire();
+	if(!isWork() && !isTerminatedFlag && !isPausedFlag) {
+		isWaitingFlag = true;
+		if(haveWorkJoiners) {
+			isWorkWaiting.broadcast();
+		}
+		if(timeoutSeconds) {
+			isWorkWaiting.wait(isWorkLock, timeoutSeconds * 1000000);
+		} else {
+			isWorkWaiting.wait(isWorkLock);
+		}
+		isWaitingFlag = false;
+	}
+	isWorkLock.release();
+	stopAwaitingWork();
+}
+
+void Worker::pollForWork() {
+	if(haveWorkJoiners) {
+		releaseWorkJoiners();
+	}
+	unsigned int spins = 0;
+	while(!isWaitOver()) {
+		if(waitStrategy.type == pthreadWrapper::WaitStrategy::BUSY_SPIN || spins < waitStrategy.spinCount) {
+			spins++;
+			pthreadWrapper::WaitStrategy::cpuRelax();
+		} else if(waitStrategy.type == pthreadWrapper::WaitStrategy::SPIN_THEN_YIELD) {
+			sched_yield();
+		} else {
+			/* the wait is over once notified, so the worker checks for work again only after registering as a waiter */
+			startAwaitingWork();
+			int key = workSignal.prepareWait();
+			if(isWaitOver()) {
+				workSignal.cancelWait();
+			} else {
+				workSignal.wait(key, timeoutSeconds * 1000000);
+			}
+			stopAwaitingWork();
+			return;
+		}
+	}
+}
+
+void Worker::releaseWorkJoiners() {
+	isWorkLock.acquire();
+	if(haveWorkJoiners) {
+		haveWorkJoiners = false;
+		isWorkWaiting.broadcast();
+	}
+	isWorkLock.release();
+}
+
+void Worker::startAwaitingWork() {
+	if(doorbell) {
+		doorbell->rearm();
+	}
+	isAwaitingWorkFlag.store(true, std::memory_order_relaxed);
+	if(awaitingWorkCount) {
+		awaitingWorkCount->fetch_add(1, std::memory_order_seq_cst);
+	}
+	if(awaitingWorkHint) {
+		awaitingWorkHint->store(identifier, std::memory_order_relaxed);
+	}
+	/* orders the count before the check for work that follows, pairing with the fence in QueueProcessor::hasAwaitingWorkers */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void Worker::stopAwaitingWork() {
+	if(isAwaitingWorkFlag.exchange(false, std::memory_order_relaxed) && awaitingWorkCount) {
+		awaitingWorkCount->fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+bool Worker::wakeIfWork() {
+	if(!isAwaitingWorkFlag.load(std::memory_order_relaxed) || !isWorkReady()) {
+		return false;
+	}
+	bool awaiting = true;
+	if(!isAwaitingWorkFlag.compare_exchange_strong(awaiting, false, std::memory_order_relaxed)) {
+		/* the worker woke up, or another thread is waking it */
+		return false;
+	}
+	if(awaitingWorkCount) {
+		awaitingWorkCount->fetch_sub(1, std::memory_order_relaxed);
+	}
+	signal();
+	return true;
+}
+
 void Worker::signalDead() {
 	hasDiedLock.acquire();
 	isDeadFlag = true;
@@ -101,12 +192,18 @@ void Worker::join() {
 }
 
 void Worker::signal(bool block) {
+	if(!block && waitStrategy.type != pthreadWrapper::WaitStrategy::CONDITION_WAIT) {
+		/* a spinning worker needs no signal, and a parked worker is woken without a lock */
+		workSignal.notify();
+		return;
+	}
 	isWorkLock.acquire();
 	if(isWaitingFlag) {
 		isWorkWaiting.signal();
 	}
 	if(block && !isTerminatedFlag && isStartedFlag) {
 		haveWorkJoiners = true;
+		workSignal.notify();
 		isWorkWaiting.wait(isWorkLock);
 	}
 	isWorkLock.release();
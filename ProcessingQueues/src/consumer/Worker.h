@@ -6,10 +6,14 @@
 #ifndef CONSUMER_H_
 #define CONSUMER_H_
 
+#include <atomic>
 #include <sstream>
 
+#include "WakeupDoorbell.h"
 #include "threading/Condition.h"
+#include "threading/EventCount.h"
 #include "threading/Thread.h"
+#include "threading/WaitStrategy.h"
 
 namespace hpqueue {
 
@@ -34,6 +38,26 @@ class Worker : public pthreadWrapper::Runnable {
 	pthreadWrapper::Condition hasPaused;
 	pthreadWrapper::Condition isIdle;
 
+	pthreadWrapper::WaitStrategy waitStrategy;
+
+	/* wakes the worker when it is parked by the SPIN_THEN_PARK wait strategy */
+	pthreadWrapper::EventCount workSignal;
+
+	/*
+	 * True while the worker is about to sleep or is asleep waiting for work, until it wakes or is claimed by wakeIfWork.
+	 * Workers that are spinning are not waiting, since they find work without being signalled.
+	 */
+	std::atomic<bool> isAwaitingWorkFlag;
+
+	/* counts the workers of a processor that are waiting for work, or NULL, see setAwaitingWorkCount */
+	std::atomic<unsigned int> *awaitingWorkCount;
+
+	/* records the identifier of the worker of a processor that most recently started waiting for work, or NULL, see setAwaitingWorkHint */
+	std::atomic<unsigned int> *awaitingWorkHint;
+
+	/* the doorbell rearmed when the worker runs out of work, or NULL, see setDoorbell */
+	WakeupDoorbell *doorbell;
+
 	/* implement these virtual methods in a subclass */
 
 	/* called by the worker itself when it starts up */
@@ -48,10 +72,47 @@ class Worker : public pthreadWrapper::Runnable {
 	/* return true when there is work to do */
 	virtual bool isWork() = 0;
 
+	/* return true when there is work to do, as with isWork but without changing any state, since other threads call it, see wakeIfWork */
+	virtual bool isWorkReady() = 0;
+
 	void run();
 
 	void signalDead();
 
+	/*
+	 * Waits for work with the condition isWorkWaiting, for the CONDITION_WAIT wait strategy.
+	 */
+	void waitOnCondition();
+
+	/*
+	 * Waits for work by spinning, yielding or parking as the wait strategy decides, without acquiring isWorkLock unless
+	 * a thread is waiting for the worker to finish its work, see signal.
+	 */
+	void pollForWork();
+
+	/*
+	 * Returns whether a worker waiting for work should return to the main loop.
+	 */
+	bool isWaitOver() {
+		return isTerminatedFlag || isPausedFlag || haveWorkJoiners || isWork();
+	}
+
+	/*
+	 * Releases the threads waiting for the worker to finish its work.
+	 */
+	void releaseWorkJoiners();
+
+	/*
+	 * Called before the worker's last check for work ahead of sleeping, so that a thread adding work
+	 * either sees the worker waiting and wakes it, or adds the work before that last check, see wakeIfWork.
+	 */
+	void startAwaitingWork();
+
+	/*
+	 * Called when the worker wakes, unless it was claimed by wakeIfWork.
+	 */
+	void stopAwaitingWork();
+
 protected:
 
 	std::string name;
@@ -75,6 +136,10 @@ public:
 		isDeadFlag(false),
 		isWaitingFlag(false),
 		haveWorkJoiners(false),
+		isAwaitingWorkFlag(false),
+		awaitingWorkCount(NULL),
+		awaitingWorkHint(NULL),
+		doorbell(NULL),
 		name(getName(identifier, name)),
 		identifier(identifier),
 		debug(false),
@@ -98,8 +163,9 @@ public:
 	 * A worker can be started at most once.
 	 * If called for the first time after stop() has been
 	 * called, it will have no effect, the worker cannot be started once it is terminated.
+	 * Returns false if the worker's thread could not be created, in which case the worker can be started again later.
 	 */
-	void start();
+	bool start();
 
 	/*
 	 * Terminate the worker.
@@ -132,6 +198,12 @@ public:
 	 */
 	void signal(bool block = false);
 
+	/*
+	 * Signals the worker if it is waiting for work and now has work to do, returning whether it was signalled.
+	 * Only one caller can wake a waiting worker, so that threads adding work at the same time wake different workers.
+	 */
+	bool wakeIfWork();
+
 	/* The worker is dead. */
 	bool isDead();
 
@@ -146,6 +218,52 @@ public:
 
 	virtual void setDebug(bool debug);
 
+	/*
+	 * Pins the worker's thread to the given CPUs, which takes effect when the worker is started.
+	 */
+	void setAffinity(const pthreadWrapper::CpuSet &cpus) {
+		thread.setAffinity(cpus);
+	}
+
+	/*
+	 * Sets how the worker waits when it has no work.  Must be called before the worker is started.
+	 */
+	void setWaitStrategy(const pthreadWrapper::WaitStrategy &strategy) {
+		waitStrategy = strategy;
+	}
+
+	/*
+	 * Sets the counter of waiting workers that the worker increments while waiting for work, so that threads adding work
+	 * need look for a waiting worker to wake only when there is one.  Must be called before the worker is started.
+	 */
+	void setAwaitingWorkCount(std::atomic<unsigned int> *count) {
+		awaitingWorkCount = count;
+	}
+
+	/*
+	 * Sets where the worker records its identifier when it starts waiting for work, so that threads adding work
+	 * look first at the worker that most recently started waiting.  Must be called before the worker is started.
+	 */
+	void setAwaitingWorkHint(std::atomic<unsigned int> *hint) {
+		awaitingWorkHint = hint;
+	}
+
+	/*
+	 * Sets the doorbell that coalesces the wakeups of the worker, which the worker rearms whenever it runs out of work.
+	 * Must be called before the worker is started.
+	 */
+	void setDoorbell(WakeupDoorbell *doorbell) {
+		this->doorbell = doorbell;
+	}
+
+	/*
+	 * Sets how the worker's thread is created, which takes effect when the worker is started.
+	 * A thread with no name in the configuration is named after the worker, see getName.
+	 */
+	void setThreadConfig(const pthreadWrapper::ThreadConfig &config) {
+		thread.setConfig(config);
+	}
+
 	virtual void updateStats() {}
 
 	const std::string &getName() const {
@@ -0,0 +1,228 @@
+/*
+ * ArenaBuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_ARENABUFFER_H_
+#define QUEUE_ARENABUFFER_H_
+
+#include <stddef.h>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PayloadArena.h"
+
+namespace hpqueue {
+
+/**
+ * A string or byte buffer field of a queue entry whose storage comes from a PayloadArena rather than the heap.
+ *
+ * The elements must be plain data.  Storage is allocated from the buffer's arena whenever the buffer is given new contents,
+ * and the old storage released, so that the arena can reclaim storage in the order it was allocated as queue slots
+ * are written again.  When the buffer has no arena, or the arena is full, the storage comes from the heap.
+ *
+ * Only buffers given an arena use one: the data arrays give the entries in their slots the arena of the data array,
+ * see QueueEntryBase::setPayloadArena.  A buffer constructed as a copy of another, or assigned another, keeps its own arena
+ * or lack of one, so that a copy of a slot entry kept by a consumer takes its storage from the heap rather than holding up
+ * the reclaiming of the arena.  A buffer must not outlive its arena.
+ */
+template <typename T>
+class ArenaBuffer {
+	/* the position of storage that came from the heap */
+	static const UINT_64 HEAP_POSITION = ~((UINT_64) 0);
+
+	PayloadArena *arena;
+
+	T *elements;
+
+	size_t length;
+
+	/* identifies the arena storage of the elements, or HEAP_POSITION */
+	UINT_64 position;
+
+	void releaseStorage() {
+		if(elements) {
+			if(position == HEAP_POSITION) {
+				delete[] elements;
+			} else {
+				arena->release(position);
+			}
+			elements = NULL;
+		}
+		length = 0;
+	}
+
+	/*
+	 * Replaces the storage with new storage for the given number of elements, terminated by T() as for a C string.
+	 */
+	T *allocateStorage(size_t count) {
+		T *storage = NULL;
+		UINT_64 storagePosition = HEAP_POSITION;
+		if(arena) {
+			storage = static_cast<T *>(arena->allocate((count + 1) * sizeof(T), storagePosition));
+		}
+		if(!storage) {
+			storage = new T[count + 1];
+			storagePosition = HEAP_POSITION;
+		}
+		releaseStorage();
+		elements = storage;
+		position = storagePosition;
+		length = count;
+		elements[count] = T();
+		return elements;
+	}
+
+	void take(ArenaBuffer &that) {
+		releaseStorage();
+		elements = that.elements;
+		length = that.length;
+		position = that.position;
+		that.elements = NULL;
+		that.length = 0;
+	}
+
+public:
+	ArenaBuffer(PayloadArena *arena = NULL) : arena(arena), elements(NULL), length(0), position(HEAP_POSITION) {}
+
+	ArenaBuffer(const T *values, size_t count, PayloadArena *arena = NULL) : arena(arena), elements(NULL), length(0), position(HEAP_POSITION) {
+		assign(values, count);
+	}
+
+	ArenaBuffer(const std::basic_string<T> &values, PayloadArena *arena = NULL) : arena(arena), elements(NULL), length(0), position(HEAP_POSITION) {
+		assign(values);
+	}
+
+	ArenaBuffer(const std::vector<T> &values, PayloadArena *arena = NULL) : arena(arena), elements(NULL), length(0), position(HEAP_POSITION) {
+		assign(values);
+	}
+
+	ArenaBuffer(const ArenaBuffer &that) : arena(NULL), elements(NULL), length(0), position(HEAP_POSITION) {
+		assign(that.elements, that.length);
+	}
+
+	/*
+	 * Takes over the storage of the other buffer when it comes from the heap, otherwise copies it to the heap.
+	 */
+	ArenaBuffer(ArenaBuffer &&that) : arena(NULL), elements(NULL), length(0), position(HEAP_POSITION) {
+		*this = std::move(that);
+	}
+
+	~ArenaBuffer() {
+		releaseStorage();
+	}
+
+	ArenaBuffer &operator=(const ArenaBuffer &that) {
+		if(this != &that) {
+			assign(that.elements, that.length);
+		}
+		return *this;
+	}
+
+	/*
+	 * Takes over the storage of the other buffer when it comes from the heap or from this buffer's arena, otherwise copies it.
+	 */
+	ArenaBuffer &operator=(ArenaBuffer &&that) {
+		if(this != &that) {
+			if(that.position == HEAP_POSITION || that.arena == arena) {
+				take(that);
+			} else {
+				assign(that.elements, that.length);
+			}
+		}
+		return *this;
+	}
+
+	ArenaBuffer &operator=(const std::basic_string<T> &values) {
+		return assign(values);
+	}
+
+	ArenaBuffer &operator=(const std::vector<T> &values) {
+		return assign(values);
+	}
+
+	ArenaBuffer &assign(const T *values, size_t count) {
+		if(count == 0) {
+			releaseStorage();
+		} else {
+			/* the values may be the current contents, so they are copied before the current storage is released */
+			T *storage = elements;
+			elements = NULL;
+			UINT_64 storagePosition = position;
+			allocateStorage(count);
+			std::memcpy(elements, values, count * sizeof(T));
+			if(storage) {
+				if(storagePosition == HEAP_POSITION) {
+					delete[] storage;
+				} else {
+					arena->release(storagePosition);
+				}
+			}
+		}
+		return *this;
+	}
+
+	ArenaBuffer &assign(const std::basic_string<T> &values) {
+		return assign(values.data(), values.size());
+	}
+
+	ArenaBuffer &assign(const std::vector<T> &values) {
+		return assign(values.empty() ? NULL : &values[0], values.size());
+	}
+
+	/*
+	 * Uses the given arena for storage from now on, moving the current contents into it.
+	 */
+	void setArena(PayloadArena *payloadArena) {
+		if(arena != payloadArena) {
+			ArenaBuffer contents(payloadArena);
+			contents.assign(elements, length);
+			releaseStorage();
+			arena = payloadArena;
+			take(contents);
+		}
+	}
+
+	PayloadArena *getArena() const {
+		return arena;
+	}
+
+	const T *data() const {
+		return elements;
+	}
+
+	/*
+	 * Returns the elements terminated by T(), such as a null-terminated string.
+	 */
+	const T *c_str() const {
+		static const T empty = T();
+		return elements ? elements : &empty;
+	}
+
+	size_t size() const {
+		return length;
+	}
+
+	bool empty() const {
+		return length == 0;
+	}
+
+	const T &operator[](size_t index) const {
+		return elements[index];
+	}
+
+	std::basic_string<T> str() const {
+		return std::basic_string<T>(c_str(), length);
+	}
+};
+
+typedef ArenaBuffer<char> ArenaString;
+
+typedef ArenaBuffer<INT_8> ArenaBytes;
+
+} /* namespace hpqueue */
+
+#endif /* QUEUE_ARENABUFFER_H_ */
@@ -0,0 +1,94 @@
+/*
+ * EpochReclaimer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_EPOCHRECLAIMER_H_
+#define QUEUE_EPOCHRECLAIMER_H_
+
+#include <atomic>
+
+#include "ProcessingQueue.h"
+
+namespace hpqueue {
+
+/**
+ * Tracks when memory that threads may still be reading can be deleted, without the threads taking any locks.
+ *
+ * A thread calls enter before it loads a pointer to shared memory that can be retired, and exit once it no longer uses the memory.
+ * Memory is retired once no new thread can load a pointer to it, recording the epoch at which it was retired.
+ * The epoch only advances when no thread remains inside the epoch before the current one,
+ * so once the epoch has advanced twice past the retire epoch, every thread that could have loaded the pointer has exited.
+ *
+ * Threads inside even epochs and odd epochs are counted separately.  A thread inside the current or previous epoch
+ * is counted by the parity of that epoch, and the counter of the next epoch, which has the same parity as the previous epoch,
+ * must drop to zero before the epoch can advance.
+ */
+class EpochReclaimer {
+	char epochPadding[CACHE_LINE_SIZE];
+
+	std::atomic<unsigned int> epoch;
+
+	char countPadding[CACHE_LINE_SIZE];
+
+	/*
+	 * the number of threads inside even and odd epochs
+	 */
+	std::atomic<int> activeCount[2];
+
+	char endPadding[CACHE_LINE_SIZE];
+
+public:
+	EpochReclaimer() : epoch(0) {
+		activeCount[0].store(0, std::memory_order_relaxed);
+		activeCount[1].store(0, std::memory_order_relaxed);
+	}
+
+	/*
+	 * Returns the epoch entered, which must be passed to exit.
+	 */
+	unsigned int enter() {
+		unsigned int current = epoch.load();
+		while(true) {
+			activeCount[current & 1].fetch_add(1);
+			unsigned int now = epoch.load();
+			if(now == current) {
+				return current;
+			}
+			/* the epoch advanced before we were counted, so we enter the new epoch instead */
+			activeCount[current & 1].fetch_sub(1);
+			current = now;
+		}
+	}
+
+	void exit(unsigned int enteredEpoch) {
+		activeCount[enteredEpoch & 1].fetch_sub(1, std::memory_order_release);
+	}
+
+	unsigned int getEpoch() {
+		return epoch.load();
+	}
+
+	/*
+	 * Advances the epoch if no thread remains inside the previous epoch, returning whether it advanced.
+	 */
+	bool tryAdvance() {
+		unsigned int current = epoch.load();
+		if(activeCount[(current - 1) & 1].load() != 0) {
+			return false;
+		}
+		return epoch.compare_exchange_strong(current, current + 1);
+	}
+
+	/*
+	 * Returns whether memory retired at the given epoch can no longer be in use.
+	 */
+	bool isReclaimable(unsigned int retireEpoch) {
+		return epoch.load() - retireEpoch >= 2;
+	}
+};
+
+}
+
+#endif /* QUEUE_EPOCHRECLAIMER_H_ */
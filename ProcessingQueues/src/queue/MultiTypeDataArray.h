@@ -0,0 +1,144 @@
+/*
+ * MultiTypeDataArray.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_MULTITYPEDATAARRAY_H_
+#define QUEUE_MULTITYPEDATAARRAY_H_
+
+#include <new>
+#include <type_traits>
+
+#include "ProcessingQueueDataArray.h"
+#include "QueueEntryTypes.h"
+
+namespace hpqueue {
+
+/**
+ * Stores entries of any of the types Types, each slot holding at most one entry.
+ *
+ * Each slot is sized to the largest of the types rather than holding an entry of every type,
+ * and tracks the type of the entry it holds with a type index.  Slots start out empty, and an entry is constructed
+ * in a slot only when the slot is first written with an entry of its type.  A slot keeps its entry when it is
+ * written again with an entry of the same type, so that memory held by the entry such as string buffers is reused.
+ * When written with an entry of another type, the old entry is destroyed and an entry of the new type constructed.
+ * Entries are destroyed when their data entries are deleted.  With a payload arena, entries are given the arena when constructed.
+ *
+ * The slot type of an entry is found from its type tag, see QueueEntryTypes.
+ * As with the other data arrays, an entry of an untagged type derived from one of the types is stored as that type.
+ * Each of the types must be default constructible.
+ */
+template <class... Types>
+class MultiTypeDataArray : public ProcessingQueueDataArray {
+	/* the type index of an empty slot */
+	static const unsigned int NO_ENTRY = QueueEntryTypes<Types...>::NO_TYPE;
+
+	typedef QueueEntryBase *(*EntryConstructor)(void *address);
+
+	template <class T>
+	static QueueEntryBase *constructEntry(void *address) {
+		return new (address) T();
+	}
+
+	static unsigned int getTypeIndex(QueueEntryBase &entry) {
+		return QueueEntryTypes<Types...>::getTypeIndex(entry);
+	}
+
+	struct MultiTypeQueueData : public QueueData {
+		typename std::aligned_union<0, Types...>::type storage;
+
+		/* the entry constructed in storage, or NULL if the slot is empty */
+		QueueEntryBase *entry;
+
+		unsigned int typeIndex;
+
+		MultiTypeQueueData() : entry(NULL), typeIndex(NO_ENTRY) {}
+
+		~MultiTypeQueueData() {
+			destroy();
+		}
+
+		void destroy() {
+			if(entry) {
+				entry->~QueueEntryBase();
+				entry = NULL;
+				typeIndex = NO_ENTRY;
+			}
+		}
+
+		QueueEntryBase *getQueueEntry(QueueEntryBase &that) {
+			return getQueueEntry(that, NULL);
+		}
+
+		QueueEntryBase *getQueueEntry(QueueEntryBase &that, PayloadArena *payloadArena) {
+			return getEntryOfType(getTypeIndex(that), payloadArena);
+		}
+
+		QueueEntryBase *getTaggedEntry(unsigned int typeTag, PayloadArena *payloadArena) {
+			return getEntryOfType(QueueEntryTypes<Types...>::getTagIndex(typeTag), payloadArena);
+		}
+
+		/*
+		 * Returns the entry of the type with the given type index, constructing it if the slot holds another type,
+		 * or NULL if the index is NO_ENTRY.
+		 */
+		QueueEntryBase *getEntryOfType(unsigned int index, PayloadArena *payloadArena) {
+			if(index == NO_ENTRY) {
+				return NULL;
+			}
+			if(index != typeIndex) {
+				static const EntryConstructor constructors[] = {&constructEntry<Types>...};
+				destroy();
+				entry = constructors[index](&storage);
+				typeIndex = index;
+				if(payloadArena) {
+					entry->setPayloadArena(payloadArena);
+				}
+			}
+			return entry;
+		}
+
+	private:
+		MultiTypeQueueData(const MultiTypeQueueData &);
+
+		MultiTypeQueueData &operator=(const MultiTypeQueueData &);
+	};
+
+	bool isCompatibleEntry(QueueEntryBase &entry) {
+		return getTypeIndex(entry) != NO_ENTRY;
+	}
+
+	bool isCompatibleType(unsigned int typeTag) {
+		return QueueEntryTypes<Types...>::getTagIndex(typeTag) != NO_ENTRY;
+	}
+
+	QueueData &getEntry(unsigned int index) {
+		MultiTypeQueueData *entries = static_cast<MultiTypeQueueData *>(queueDataEntries);
+		return entries[index];
+	}
+
+	QueueData *resize(unsigned int queueSize) {
+		return ProcessingQueueDataArray::resize(queueSize, allocateEntries<MultiTypeQueueData>(queueSize));
+	}
+
+	void deleteEntries(QueueData *entries) {
+		destroyEntries(static_cast<MultiTypeQueueData *>(entries));
+	}
+
+	unsigned int getEntrySize() {
+		return sizeof(MultiTypeQueueData);
+	}
+
+public:
+	MultiTypeDataArray(unsigned int payloadArenaSize = 0, const SlotStoragePolicy &storagePolicy = SlotStoragePolicy()) :
+		ProcessingQueueDataArray(payloadArenaSize, storagePolicy) {}
+
+	virtual ~MultiTypeDataArray() {
+		deleteEntries(queueDataEntries);
+	}
+};
+
+} /* namespace hpqueue */
+
+#endif /* QUEUE_MULTITYPEDATAARRAY_H_ */
@@ -0,0 +1,92 @@
+/*
+ * PayloadArena.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "PayloadArena.h"
+
+namespace hpqueue {
+
+PayloadArena::PayloadArena(unsigned int size) :
+	memory(NULL),
+	chunkCount((size + CHUNK_SIZE - 1) / CHUNK_SIZE),
+	blockChunks(NULL),
+	releasedPositions(NULL),
+	head(0),
+	tail(0),
+	reclaiming(false),
+	failedCount(0) {
+	if(chunkCount == 0) {
+		chunkCount = 1;
+	}
+	memory = new char[chunkCount * CHUNK_SIZE];
+	blockChunks = new UINT_32[chunkCount];
+	releasedPositions = new std::atomic<UINT_64>[chunkCount];
+	for(unsigned int i = 0; i < chunkCount; i++) {
+		releasedPositions[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+PayloadArena::~PayloadArena() {
+	delete[] memory;
+	delete[] blockChunks;
+	delete[] releasedPositions;
+}
+
+void *PayloadArena::allocate(size_t size, UINT_64 &position) {
+	UINT_64 count = size ? (size + CHUNK_SIZE - 1) / CHUNK_SIZE : 1;
+	if(count > chunkCount / 2) {
+		/* a block must fit even when it is preceded by the padding to the end of the ring */
+		failedCount.fetch_add(1, std::memory_order_relaxed);
+		return NULL;
+	}
+	bool reclaimed = false;
+	UINT_64 current = head.load(std::memory_order_relaxed);
+	while(true) {
+		/* a block does not wrap around the end of the ring, so a block that would is placed at the start instead */
+		unsigned int offset = current % chunkCount;
+		UINT_64 start = (offset + count > chunkCount) ? (current + chunkCount - offset) : current;
+		UINT_64 end = start + count;
+		if(end - tail.load(std::memory_order_acquire) > chunkCount) {
+			if(reclaimed) {
+				failedCount.fetch_add(1, std::memory_order_relaxed);
+				return NULL;
+			}
+			reclaim();
+			reclaimed = true;
+			current = head.load(std::memory_order_relaxed);
+			continue;
+		}
+		if(head.compare_exchange_weak(current, end, std::memory_order_relaxed)) {
+			if(start != current) {
+				/* the padding to the end of the ring is a block that is released right away */
+				blockChunks[offset] = start - current;
+				release(current);
+			}
+			unsigned int startOffset = start % chunkCount;
+			blockChunks[startOffset] = count;
+			position = start;
+			return memory + (startOffset * CHUNK_SIZE);
+		}
+	}
+}
+
+void PayloadArena::reclaim() {
+	if(reclaiming.exchange(true, std::memory_order_acquire)) {
+		return;
+	}
+	UINT_64 current = tail.load(std::memory_order_relaxed);
+	UINT_64 end = head.load(std::memory_order_acquire);
+	while(current < end) {
+		unsigned int offset = current % chunkCount;
+		if(releasedPositions[offset].load(std::memory_order_acquire) != current + 1) {
+			break;
+		}
+		current += blockChunks[offset];
+	}
+	tail.store(current, std::memory_order_release);
+	reclaiming.store(false, std::memory_order_release);
+}
+
+} /* namespace hpqueue */
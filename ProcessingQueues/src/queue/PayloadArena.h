@@ -0,0 +1,110 @@
+/*
+ * PayloadArena.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_PAYLOADARENA_H_
+#define QUEUE_PAYLOADARENA_H_
+
+#include <stddef.h>
+#include <atomic>
+
+#include "base/primitiveTypes.h"
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+namespace hpqueue {
+
+/**
+ * A ring of memory for the variable-length data of queue entries, such as strings and byte buffers,
+ * so that copying an entry into a queue slot does not go to the heap, see ArenaBuffer.
+ *
+ * Storage is allocated as a block of consecutive chunks at the head of the ring by advancing the head with an atomic
+ * compare-and-swap, so threads allocate without locking.  Blocks are released in any order, typically when the queue slot
+ * holding them is written again, and released blocks are reclaimed in bulk by advancing the tail of the ring past them
+ * when an allocation finds the ring full.  A block that is not released holds up the reclaiming of the blocks after it,
+ * and an allocation that does not fit returns NULL, so callers must be able to fall back to the heap.
+ *
+ * Positions in the ring count chunks from the creation of the arena and never wrap, so a block is identified by its position.
+ */
+class PayloadArena {
+public:
+	static const unsigned int CHUNK_SIZE = CACHE_LINE_SIZE;
+
+private:
+	char *memory;
+
+	unsigned int chunkCount;
+
+	/* the number of chunks of the block starting at each chunk */
+	UINT_32 *blockChunks;
+
+	/* one past the position of the block starting at each chunk once that block has been released */
+	std::atomic<UINT_64> *releasedPositions;
+
+	char headPadding[CACHE_LINE_SIZE];
+
+	/* the position of the next chunk to allocate */
+	std::atomic<UINT_64> head;
+
+	char tailPadding[CACHE_LINE_SIZE];
+
+	/* the position of the oldest chunk not yet reclaimed */
+	std::atomic<UINT_64> tail;
+
+	std::atomic<bool> reclaiming;
+
+	/* the number of allocations that did not fit, see getFailedCount */
+	std::atomic<UINT_64> failedCount;
+
+	char endPadding[CACHE_LINE_SIZE];
+
+	PayloadArena(const PayloadArena &);
+
+	PayloadArena &operator=(const PayloadArena &);
+
+public:
+	/*
+	 * Creates an arena of the given number of bytes, rounded up to a whole number of chunks.
+	 */
+	PayloadArena(unsigned int size);
+
+	~PayloadArena();
+
+	/*
+	 * Returns storage of at least the given number of bytes, aligned to a chunk, with position set to identify it for release.
+	 * Returns NULL if the arena does not have the space, even after reclaiming the blocks released so far.
+	 */
+	void *allocate(size_t size, UINT_64 &position);
+
+	/*
+	 * Releases the storage at the given position, to be reclaimed once all the blocks allocated before it are released too.
+	 */
+	void release(UINT_64 position) {
+		releasedPositions[position % chunkCount].store(position + 1, std::memory_order_release);
+	}
+
+	/*
+	 * Advances the tail of the ring past the released blocks at the tail, unless another thread is already doing so.
+	 */
+	void reclaim();
+
+	/*
+	 * Returns the number of allocations that returned NULL, so that their storage came from the heap.
+	 * A count that keeps growing means the arena is too small, or a block is held for long enough to stop the tail of the ring.
+	 */
+	UINT_64 getFailedCount() {
+		return failedCount.load(std::memory_order_relaxed);
+	}
+
+	unsigned int getSize() {
+		return chunkCount * CHUNK_SIZE;
+	}
+};
+
+} /* namespace hpqueue */
+
+#endif /* QUEUE_PAYLOADARENA_H_ */
@@ -0,0 +1,46 @@
+/*
+ * PlainDataEntry.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_PLAINDATAENTRY_H_
+#define QUEUE_PLAINDATAENTRY_H_
+
+#include <type_traits>
+
+namespace hpqueue {
+
+template <class T>
+struct PlainDataType {
+	typedef void type;
+};
+
+/**
+ * Indicates whether an entry of type T can be copied onto another entry of exactly type T with memcpy
+ * rather than with the assignment operator, so that queues copy such entries into their slots,
+ * and relocate runs of them when resized, with memcpy.
+ *
+ * An entry type opts in by declaring the data class holding its fields as PlainData, as in
+ *	typedef QueueEntryData3 PlainData;
+ * The data class must be trivially copyable, such as a class of primitive fields, InlineString and InlineBytes, which is checked.
+ * The entry type itself must hold no data besides that of the data class and QueueEntryBase, and must not hold storage
+ * from a payload arena.  This cannot be checked, since entries are polymorphic and so are never trivially copyable themselves.
+ *
+ * The trait may also be specialized directly for an entry type.
+ */
+template <class T, class Enable = void>
+struct PlainDataEntry {
+	static const bool value = false;
+};
+
+template <class T>
+struct PlainDataEntry<T, typename PlainDataType<typename T::PlainData>::type> {
+	static_assert(std::is_trivially_copyable<typename T::PlainData>::value, "the PlainData of an entry type must be trivially copyable");
+
+	static const bool value = true;
+};
+
+} /* namespace hpqueue */
+
+#endif /* QUEUE_PLAINDATAENTRY_H_ */
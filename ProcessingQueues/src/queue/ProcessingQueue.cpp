@@ -11,20 +11,56 @@ using namespace std;
 
 namespace hpqueue {
 
+unsigned int ProcessingQueue::getInitialSize(unsigned int size, bool powerOfTwoSize) {
+	if(!powerOfTwoSize) {
+		return size;
+	}
+	unsigned int powerOfTwo = 1;
+	while(powerOfTwo < size && powerOfTwo <= UINT_MAX / 2) {
+		powerOfTwo <<= 1;
+	}
+	return powerOfTwo;
+}
+
 unsigned int ProcessingQueue::getNewQueueSize() {
 	unsigned int newSize = getCurrentSize();
 	if(newSize >= UINT_MAX / 2) {
-		newSize = UINT_MAX;
+		newSize = powerOfTwoSize ? (UINT_MAX / 2 + 1) : UINT_MAX;
 	} else {
 		newSize *= 2;
 	}
 
-	unsigned int maxSize = MAX_QUEUE_SIZE(getEntrySize());
+	unsigned int maxSize = getMaxQueueSize();
 	if(newSize > maxSize) {
 		return maxSize;
 	}
 	return newSize;
 }
 
+unsigned int ProcessingQueue::getNewQueueSize(unsigned int minimumSize) {
+	unsigned int newSize = getCurrentSize();
+	unsigned int maxSize = getMaxQueueSize();
+	do {
+		if(newSize >= maxSize / 2) {
+			return maxSize;
+		}
+		newSize *= 2;
+	} while(newSize < minimumSize);
+	return newSize;
+}
+
+unsigned int ProcessingQueue::getMaxQueueSize() {
+	unsigned int maxSize = MAX_QUEUE_SIZE(getEntrySize());
+	if(powerOfTwoSize) {
+		/* round down to a power of two */
+		unsigned int powerOfTwo = 1;
+		while(powerOfTwo <= maxSize / 2) {
+			powerOfTwo <<= 1;
+		}
+		maxSize = powerOfTwo;
+	}
+	return maxSize;
+}
+
 }
 
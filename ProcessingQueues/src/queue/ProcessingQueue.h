@@ -9,6 +9,7 @@
 #define PROCESSINGQUEUE_H_
 
 #include "ProcessingQueueDataArray.h"
+#include "QueueEntryWriter.h"
 #include "ReaderIndex.h"
 
 /*
@@ -18,6 +19,14 @@
 #define MAX_QUEUE_SIZE_BYTES(maxBytes, entrySize) ((maxBytes) / (entrySize))
 #define MAX_QUEUE_SIZE(entrySize) MAX_QUEUE_SIZE_BYTES(500 * 1024 * 1024, entrySize)
 
+/*
+ * The size in bytes of a processor cache line.
+ * Fields written by different threads are separated by at least this many bytes so they do not share a cache line.
+ */
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
 
 namespace hpqueue {
 
@@ -43,17 +52,36 @@ namespace hpqueue {
 class ProcessingQueue {
 	bool deleteQueueData;
 protected:
+	/*
+	 * When true, the queue size is always a power of two so that indices wrap around with a mask instead of a modulo.
+	 */
+	const bool powerOfTwoSize;
+
 	QueueEntryBase **queueData;
 	ProcessingQueueDataArray *dataEntries;
 	volatile unsigned int currentSize;
 
+	/*
+	 * The data entries that dataEntries held before this queue was created, or NULL if there were none.
+	 * When a queue is created to replace an older queue sharing the same dataEntries, these are the data entries of the older queue.
+	 */
+	QueueData *previousDataEntries;
+
 public:
-	ProcessingQueue(unsigned int queueSize, ProcessingQueueDataArray *dataEntries, bool deleteQueueData = false) :
+	/*
+	 * When numaNode is not negative, the slots of the data entries are bound to that NUMA node from now on, see SlotStoragePolicy.
+	 */
+	ProcessingQueue(unsigned int queueSize, ProcessingQueueDataArray *dataEntries, bool deleteQueueData = false, bool powerOfTwoSize = false, int numaNode = -1) :
 		deleteQueueData(deleteQueueData),
-		queueData(new QueueEntryBase *[queueSize]),
+		powerOfTwoSize(powerOfTwoSize),
+		queueData(new QueueEntryBase *[getInitialSize(queueSize, powerOfTwoSize)]),
 		dataEntries(dataEntries),
-		currentSize(queueSize) {
-		dataEntries->resize(queueSize);
+		currentSize(getInitialSize(queueSize, powerOfTwoSize)),
+		previousDataEntries(NULL) {
+		if(numaNode >= 0) {
+			dataEntries->setNumaNode(numaNode);
+		}
+		previousDataEntries = dataEntries->resize(currentSize);
 	}
 
 	virtual ~ProcessingQueue() {
@@ -65,6 +93,11 @@ public:
 
 	virtual int add(QueueEntryBase &entry) = 0;
 
+	/*
+	 * Adds an entry populated by the writer, which can move or construct the entry in its queue slot rather than copying it.
+	 */
+	virtual int add(QueueEntryWriter &writer) = 0;
+
 	/*
 	 * Remove an entry from the queue.
 	 * The entry that is removed depends on the queue type: either the first in (FIFO), or a selected entry.
@@ -77,21 +110,59 @@ public:
 		return (index + 1) % currentSize;
 	}
 
+	/*
+	 * When the size is a power of two, size - 1 is a mask of the valid indices.
+	 */
+	static inline int nextIndex(int index, unsigned int currentSize, bool powerOfTwoSize) {
+		return powerOfTwoSize ? ((index + 1) & (currentSize - 1)) : nextIndex(index, currentSize);
+	}
+
 	inline int nextIndex(int index) {
-		return nextIndex(index, currentSize);
+		return nextIndex(index, currentSize, powerOfTwoSize);
+	}
+
+	/*
+	 * Returns the index that is count slots past the given index.
+	 */
+	inline int advanceIndex(int index, unsigned int count) {
+		return powerOfTwoSize ? ((index + count) & (currentSize - 1)) : ((index + count) % currentSize);
 	}
 
+	/*
+	 * Returns the smallest power of two that is at least size, or size itself if not in power of two mode.
+	 */
+	static unsigned int getInitialSize(unsigned int size, bool powerOfTwoSize);
+
 	unsigned int getCurrentSize() {
 		return currentSize;
 	}
 
 	virtual void resize(unsigned int size) = 0;
 
+	/*
+	 * Returns whether the queue can be made larger by calling resize.
+	 * A queue that grows by itself as entries are added returns false.
+	 */
+	virtual bool isResizable() {
+		return currentSize < getMaxQueueSize();
+	}
+
 	virtual unsigned int getEntrySize() {
 		return dataEntries->getEntrySize() + sizeof(QueueEntryBase *);
 	}
 
 	unsigned int getNewQueueSize();
+
+	/*
+	 * Returns the size the queue should grow to in a single resize so that it has at least minimumSize slots,
+	 * or the max size if that is smaller.
+	 */
+	unsigned int getNewQueueSize(unsigned int minimumSize);
+
+	/*
+	 * Returns the largest size the queue may grow to.
+	 */
+	unsigned int getMaxQueueSize();
 };
 
 }
@@ -8,7 +8,11 @@
 #ifndef PROCESSINGQUEUEDATAARRAY_H_
 #define PROCESSINGQUEUEDATAARRAY_H_
 
+#include <new>
+
+#include "queue/PayloadArena.h"
 #include "queue/QueueEntryBase.h"
+#include "queue/SlotStorage.h"
 
 namespace hpqueue {
 
@@ -27,6 +31,24 @@ struct QueueData {
 	 * or NULL if this cell cannot store entries of the given type.
 	 */
 	virtual QueueEntryBase *getQueueEntry(QueueEntryBase &entry) = 0;
+
+	/**
+	 * As above, for a cell of a data array with a payload arena.
+	 * Cells that construct entries when they are written override this to give the new entries the arena,
+	 * see QueueEntryBase::setPayloadArena.
+	 */
+	virtual QueueEntryBase *getQueueEntry(QueueEntryBase &entry, PayloadArena *) {
+		return getQueueEntry(entry);
+	}
+
+	/**
+	 * Returns a pointer to an entry of the type with the given tag in this cell, see QueueEntryBase::getTypeTag,
+	 * or NULL if this cell cannot store entries of that type or cannot tell the type from its tag.
+	 * Cells that construct entries give the new entries the payload arena, if not NULL.
+	 */
+	virtual QueueEntryBase *getTaggedEntry(unsigned int, PayloadArena *) {
+		return NULL;
+	}
 };
 
 class ProcessingQueueDataArray {
@@ -35,6 +57,52 @@ class ProcessingQueueDataArray {
 protected:
 	QueueData *queueDataEntries;
 
+	/*
+	 * Storage for the variable-length data of the entries, or NULL if the entries use the heap, see ArenaBuffer.
+	 */
+	PayloadArena *payloadArena;
+
+	/*
+	 * The memory backing the arrays of slots returned by allocateEntries.
+	 */
+	SlotStoragePolicy storagePolicy;
+
+	/*
+	 * Allocates an array of count default constructed slots according to the storage policy,
+	 * for subclasses to use in place of new[] in their implementations of resize.
+	 */
+	template <class Entry>
+	Entry *allocateEntries(unsigned int count) {
+		Entry *entries = static_cast<Entry *>(SlotStorage::allocate(sizeof(Entry), count, storagePolicy));
+		unsigned int constructed = 0;
+		try {
+			for(; constructed < count; constructed++) {
+				new (entries + constructed) Entry();
+			}
+		} catch(...) {
+			while(constructed > 0) {
+				entries[--constructed].~Entry();
+			}
+			SlotStorage::release(entries);
+			throw;
+		}
+		return entries;
+	}
+
+	/*
+	 * Destroys an array of slots returned by allocateEntries, in place of delete[] in implementations of deleteEntries.
+	 */
+	template <class Entry>
+	static void destroyEntries(Entry *entries) {
+		if(entries) {
+			unsigned int count = SlotStorage::getCount(entries);
+			for(unsigned int i = 0; i < count; i++) {
+				entries[i].~Entry();
+			}
+			SlotStorage::release(entries);
+		}
+	}
+
 	QueueData *resize(unsigned int queueSize, QueueData *newDataEntries) {
 		QueueData *oldEntries = queueDataEntries;
 		queueDataEntries = newDataEntries;
@@ -43,11 +111,20 @@ protected:
 	}
 
 public:
-	ProcessingQueueDataArray() :
+	/*
+	 * A data array with a payload arena of the given number of bytes, or with no arena if the size is 0,
+	 * whose slots are stored according to the given policy.
+	 * Subclasses must delete their data entries in their own destructors, before the arena is deleted.
+	 */
+	ProcessingQueueDataArray(unsigned int payloadArenaSize = 0, const SlotStoragePolicy &storagePolicy = SlotStoragePolicy()) :
 		currentSize(0),
-		queueDataEntries(NULL) {}
+		queueDataEntries(NULL),
+		payloadArena(payloadArenaSize ? new PayloadArena(payloadArenaSize) : NULL),
+		storagePolicy(storagePolicy) {}
 
-	virtual ~ProcessingQueueDataArray() {}
+	virtual ~ProcessingQueueDataArray() {
+		delete payloadArena;
+	}
 
 	/*
 	 * Returns the queue's entry at the specified index that corresponds to the given entry.
@@ -60,7 +137,18 @@ public:
 	 */
 	QueueEntryBase *getQueueEntry(unsigned int index, QueueEntryBase &entry) {
 		if(index < currentSize) {
-			return getEntry(index).getQueueEntry(entry);
+			return payloadArena ? getEntry(index).getQueueEntry(entry, payloadArena) : getEntry(index).getQueueEntry(entry);
+		}
+		return NULL;
+	}
+
+	/*
+	 * Returns the queue's entry at the specified index for entries of the type with the given tag,
+	 * without needing an entry of that type, or NULL if this queue cannot store entries of that type, see isCompatibleType.
+	 */
+	QueueEntryBase *getTaggedEntry(unsigned int index, unsigned int typeTag) {
+		if(index < currentSize) {
+			return getEntry(index).getTaggedEntry(typeTag, payloadArena);
 		}
 		return NULL;
 	}
@@ -70,6 +158,15 @@ public:
 	 */
 	virtual bool isCompatibleEntry(QueueEntryBase &entry) = 0;
 
+	/**
+	 * Returns true if entries of the type with the given tag can be stored within this queue, see QueueEntryBase::getTypeTag.
+	 * Data arrays that select slots by the type of an entry rather than its tag return false,
+	 * so that entries of the type can be added to them only as entries, not by tag, such as with emplace or reserve of a type.
+	 */
+	virtual bool isCompatibleType(unsigned int) {
+		return false;
+	}
+
 	/**
 	 * Subclasses must implement this method, returning a reference to an instance of a subclass
 	 * of QueueData at the given index in this queue.
@@ -80,11 +177,20 @@ public:
 	 * Resizes the data entries.
 	 *
 	 * The old data entries are returned as a pointer, so that callers may continue to read them.
-	 * Callers are responsible for calling delete[] on the returned pointer when the old data
+	 * Callers are responsible for calling deleteEntries on the returned pointer when the old data
 	 * entries are no longer required.
 	 */
 	virtual QueueData *resize(unsigned int queueSize) = 0;
 
+	/*
+	 * Makes data entries previously returned by a call to resize the current data entries once again,
+	 * so that a queue can reuse them rather than allocating new ones.
+	 * As with resize, the data entries that were current are returned.
+	 */
+	QueueData *restoreEntries(unsigned int queueSize, QueueData *entries) {
+		return resize(queueSize, entries);
+	}
+
 	/**
 	 * delete an array of data entries previously returned by a call to resize.
 	 */
@@ -95,6 +201,36 @@ public:
 	 * how much memory is consumed by this queue.
 	 */
 	virtual unsigned int getEntrySize() = 0;
+
+	/**
+	 * Returns the number of bytes to memcpy when copying an entry into a slot, or 0 if entries must be copied
+	 * with the assignment operator.  Only data arrays whose slots all hold entries of a single plain data type,
+	 * see PlainDataEntry, return a size, and only entries compatible with such a data array may be copied with memcpy.
+	 */
+	virtual size_t getPlainEntrySize() {
+		return 0;
+	}
+
+	/**
+	 * For data arrays with a plain entry size, copies count consecutive slots starting at fromIndex
+	 * of data entries previously returned by a call to resize to the current slots starting at toIndex, with one memcpy.
+	 */
+	virtual void copyEntries(QueueData * /* entries */, unsigned int /* fromIndex */, unsigned int /* toIndex */, unsigned int /* count */) {}
+
+	PayloadArena *getPayloadArena() {
+		return payloadArena;
+	}
+
+	const SlotStoragePolicy &getStoragePolicy() {
+		return storagePolicy;
+	}
+
+	/*
+	 * Binds the slot arrays allocated from now on to the given NUMA node, see SlotStoragePolicy::numaNode.
+	 */
+	void setNumaNode(int numaNode) {
+		storagePolicy.numaNode = numaNode;
+	}
 };
 
 }
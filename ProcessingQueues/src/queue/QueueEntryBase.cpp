@@ -5,6 +5,7 @@
  *      Author: sfoley
  */
 
+#include <atomic>
 #include <iostream>
 
 #include "QueueEntryBase.h"
@@ -15,5 +16,10 @@ namespace hpqueue {
 
 QueueEntryBase QueueEntryBase::nullEntry;
 
+unsigned int QueueEntryBase::registerTypeTag() {
+	static std::atomic<unsigned int> lastTypeTag(UNTAGGED);
+	return ++lastTypeTag;
+}
+
 }
 
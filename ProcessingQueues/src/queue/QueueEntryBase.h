@@ -15,17 +15,72 @@
 
 namespace hpqueue {
 
+class PayloadArena;
+
 /*
  * Represents an entry in a queue
  */
 class QueueEntryBase: public Data {
+	/*
+	 * The tag of the entry's type, see getTypeTag.
+	 */
+	unsigned int typeTag;
+
+	static unsigned int registerTypeTag();
+
+protected:
+	/*
+	 * Subclasses pass the tag of their own type, getTypeTag<T>(), so that the entry's type can be found without RTTI.
+	 */
+	QueueEntryBase(unsigned int typeTag) : typeTag(typeTag) {}
+
 public:
-	QueueEntryBase() {}
+	/*
+	 * The tag of an entry whose type did not pass its tag to the constructor.
+	 */
+	static const unsigned int UNTAGGED = 0;
+
+	QueueEntryBase() : typeTag(UNTAGGED) {}
 
 	virtual ~QueueEntryBase() {}
 
 	static QueueEntryBase nullEntry;
 
+	/*
+	 * Returns the tag of type T, a small number assigned to T when first requested.
+	 */
+	template <class T>
+	static unsigned int getTypeTag() {
+		static const unsigned int tag = registerTypeTag();
+		return tag;
+	}
+
+	/*
+	 * Returns the tag that the entry's type passed to the constructor, or UNTAGGED.
+	 * An entry of a subclass that does not pass its own tag has the tag of its superclass.
+	 */
+	unsigned int getTypeTag() const {
+		return typeTag;
+	}
+
+	/*
+	 * Returns the entry as a T, or NULL if it is not a T.
+	 * The entry's tag is checked first, and only if the tag is not that of T is RTTI used,
+	 * in case the entry is of an untagged type or a tagged subclass of T.
+	 */
+	template <class T>
+	static T *cast(QueueEntryBase &entry) {
+		if(entry.typeTag == getTypeTag<T>()) {
+			return static_cast<T *>(&entry);
+		}
+		return dynamic_cast<T *>(&entry);
+	}
+
+	template <class T>
+	static const T *cast(const QueueEntryBase &entry) {
+		return cast<T>(const_cast<QueueEntryBase &>(entry));
+	}
+
 	virtual std::string &appendDataTo(std::string &str) const {
 		return str;
 	}
@@ -49,13 +104,35 @@ public:
 	}
 
 	/**
-	 * override this method if a memcpy works as well as using the assignment operator.
-	 * For a memcpy to work, the entry should hold plain data.
+	 * Copies this entry to the destination with the assignment operator.
+	 * Queues copy entries of types that hold only plain data with memcpy instead, see PlainDataEntry.
 	 */
 	void copyTo(QueueEntryBase *destination) {
 		*destination = *this;
 	}
 
+	/**
+	 * Moves this entry to the destination, leaving this entry valid but with unspecified contents.
+	 * Used when an entry is relocated from one queue slot to another, such as when the queue is resized.
+	 */
+	void moveTo(QueueEntryBase *destination) {
+		destination->moveFrom(*this);
+	}
+
+	/**
+	 * override this method to take over the data of the given entry, such as strings and vectors, rather than copying it.
+	 * By default the data is copied with the assignment operator.
+	 */
+	virtual QueueEntryBase& moveFrom(QueueEntryBase& that) {
+		return *this = that;
+	}
+
+	/**
+	 * override this method if the entry has fields whose storage can come from a payload arena, such as ArenaBuffer fields,
+	 * to give them the arena.  Data arrays with a payload arena call it for the entries in their slots when they construct them.
+	 */
+	virtual void setPayloadArena(PayloadArena *) {}
+
 	virtual bool isNull() const {
 		return true;
 	}
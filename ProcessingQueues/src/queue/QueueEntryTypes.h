@@ -0,0 +1,96 @@
+/*
+ * QueueEntryTypes.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_QUEUEENTRYTYPES_H_
+#define QUEUE_QUEUEENTRYTYPES_H_
+
+#include <stddef.h>
+
+#include "QueueEntryBase.h"
+
+namespace hpqueue {
+
+/**
+ * A list of queue entry types, used to find which of the types an entry is, and to hand an entry to a visitor as its type.
+ *
+ * The type of an entry is found by comparing its tag with the tags of the types, see QueueEntryBase::getTypeTag.
+ * Only when none of the tags match, such as for an entry of an untagged type or of a tagged subclass of one of the types,
+ * is RTTI used, in which case the entry is taken to be the first of the types it is derived from.
+ */
+template <class... Types>
+class QueueEntryTypes {
+	typedef bool (*EntryMatcher)(QueueEntryBase &entry);
+
+	template <class T>
+	static bool isEntryOfType(QueueEntryBase &entry) {
+		return dynamic_cast<T *>(&entry) != NULL;
+	}
+
+	template <class T, class Visitor>
+	static void visitAs(QueueEntryBase &entry, Visitor &visitor) {
+		visitor(static_cast<T &>(entry));
+	}
+
+public:
+	/* the type index of an entry that is none of the types */
+	static const unsigned int NO_TYPE = sizeof...(Types);
+
+	/*
+	 * Returns the index in the list of the entry's type, or NO_TYPE if the entry is none of the types.
+	 */
+	static unsigned int getTypeIndex(QueueEntryBase &entry) {
+		static const unsigned int tags[] = {QueueEntryBase::getTypeTag<Types>()...};
+		unsigned int tag = entry.getTypeTag();
+		if(tag != QueueEntryBase::UNTAGGED) {
+			for(unsigned int i = 0; i < NO_TYPE; i++) {
+				if(tags[i] == tag) {
+					return i;
+				}
+			}
+		}
+		static const EntryMatcher matchers[] = {&isEntryOfType<Types>...};
+		for(unsigned int i = 0; i < NO_TYPE; i++) {
+			if(matchers[i](entry)) {
+				return i;
+			}
+		}
+		return NO_TYPE;
+	}
+
+	/*
+	 * Returns the index in the list of the type with the given tag, or NO_TYPE if it is none of the types.
+	 */
+	static unsigned int getTagIndex(unsigned int tag) {
+		static const unsigned int tags[] = {QueueEntryBase::getTypeTag<Types>()...};
+		for(unsigned int i = 0; i < NO_TYPE; i++) {
+			if(tags[i] == tag) {
+				return i;
+			}
+		}
+		return NO_TYPE;
+	}
+
+	/*
+	 * Calls visitor(entry) with the entry as its type from the list, through a table indexed by the type index.
+	 * The visitor must be callable with a reference to each of the types.
+	 * Returns false without calling the visitor if the entry is none of the types.
+	 */
+	template <class Visitor>
+	static bool visit(QueueEntryBase &entry, Visitor &visitor) {
+		typedef void (*EntryVisit)(QueueEntryBase &entry, Visitor &visitor);
+		static const EntryVisit visits[] = {&visitAs<Types, Visitor>...};
+		unsigned int index = getTypeIndex(entry);
+		if(index == NO_TYPE) {
+			return false;
+		}
+		visits[index](entry, visitor);
+		return true;
+	}
+};
+
+} /* namespace hpqueue */
+
+#endif /* QUEUE_QUEUEENTRYTYPES_H_ */
@@ -0,0 +1,219 @@
+/*
+ * QueueEntryWriter.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_QUEUEENTRYWRITER_H_
+#define QUEUE_QUEUEENTRYWRITER_H_
+
+#include <cstring>
+#include <new>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+
+#include "ProcessingQueueDataArray.h"
+#include "QueueEntryBase.h"
+
+namespace hpqueue {
+
+/**
+ * Selects the slot storage for an entry from a data array, when adding to a queue or reserving a slot.
+ */
+class SlotSelector {
+public:
+	virtual ~SlotSelector() {}
+
+	/*
+	 * Returns whether the data array can store the entry, see ProcessingQueueDataArray::isCompatibleEntry.
+	 */
+	virtual bool isCompatible(ProcessingQueueDataArray &dataEntries) = 0;
+
+	/*
+	 * Returns the entry in the slot of the data array at the given index to hold the entry,
+	 * or NULL if the data array cannot store it, see ProcessingQueueDataArray::getQueueEntry.
+	 */
+	virtual QueueEntryBase *select(ProcessingQueueDataArray &dataEntries, unsigned int index) = 0;
+};
+
+/*
+ * Selects the slot for an entry of the same type as a given entry.
+ */
+class EntrySlotSelector : public SlotSelector {
+	QueueEntryBase &entryType;
+
+public:
+	EntrySlotSelector(QueueEntryBase &entryType) : entryType(entryType) {}
+
+	bool isCompatible(ProcessingQueueDataArray &dataEntries) {
+		return dataEntries.isCompatibleEntry(entryType);
+	}
+
+	QueueEntryBase *select(ProcessingQueueDataArray &dataEntries, unsigned int index) {
+		return dataEntries.getQueueEntry(index, entryType);
+	}
+};
+
+/*
+ * Selects the slot for an entry of type T by the type tag of T, see ProcessingQueueDataArray::getTaggedEntry,
+ * so that no entry of type T is needed to select it.
+ */
+template <typename T>
+class TaggedSlotSelector : public SlotSelector {
+public:
+	bool isCompatible(ProcessingQueueDataArray &dataEntries) {
+		return dataEntries.isCompatibleType(QueueEntryBase::getTypeTag<T>());
+	}
+
+	QueueEntryBase *select(ProcessingQueueDataArray &dataEntries, unsigned int index) {
+		return dataEntries.getTaggedEntry(index, QueueEntryBase::getTypeTag<T>());
+	}
+};
+
+/**
+ * Populates a queue slot when adding to a queue.
+ *
+ * The queue chooses the slot storage from the data array with the writer's selector,
+ * and once it has a slot, calls writeTo to populate the slot.  A failed add never calls writeTo,
+ * so the writer may be passed to the queue again after the queue is resized.
+ */
+class QueueEntryWriter {
+public:
+	virtual ~QueueEntryWriter() {}
+
+	/*
+	 * Returns the selector of the slot storage for the entry to be written.
+	 */
+	virtual SlotSelector &getSelector() = 0;
+
+	virtual void writeTo(QueueEntryBase *destination) = 0;
+
+	/*
+	 * As above, for a slot of a data array with a payload arena, which the entry in the slot has been given.
+	 * Writers that construct a new entry in the slot override this so that the slot keeps the arena.
+	 */
+	virtual void writeTo(QueueEntryBase *destination, PayloadArena *) {
+		writeTo(destination);
+	}
+
+	/*
+	 * Populates a slot of a data array whose entries are copied with memcpy, see ProcessingQueueDataArray::getPlainEntrySize.
+	 * Writers that copy or move an existing entry copy it with memcpy, other writers populate the slot as usual.
+	 */
+	virtual void writePlainTo(QueueEntryBase *destination, size_t) {
+		writeTo(destination);
+	}
+
+protected:
+	static void copyPlainEntry(QueueEntryBase &entry, QueueEntryBase *destination, size_t plainEntrySize) {
+		std::memcpy(static_cast<void *>(destination), static_cast<const void *>(&entry), plainEntrySize);
+	}
+};
+
+/*
+ * Copies an entry into the slot with the assignment operator.
+ */
+class QueueEntryCopier : public QueueEntryWriter {
+	QueueEntryBase &entry;
+
+	EntrySlotSelector selector;
+
+public:
+	QueueEntryCopier(QueueEntryBase &entry) : entry(entry), selector(entry) {}
+
+	SlotSelector &getSelector() {
+		return selector;
+	}
+
+	void writeTo(QueueEntryBase *destination) {
+		entry.copyTo(destination);
+	}
+
+	void writePlainTo(QueueEntryBase *destination, size_t plainEntrySize) {
+		copyPlainEntry(entry, destination, plainEntrySize);
+	}
+};
+
+/*
+ * Moves an entry into the slot, see QueueEntryBase::moveFrom.
+ */
+class QueueEntryMover : public QueueEntryWriter {
+	QueueEntryBase &entry;
+
+	EntrySlotSelector selector;
+
+public:
+	QueueEntryMover(QueueEntryBase &entry) : entry(entry), selector(entry) {}
+
+	SlotSelector &getSelector() {
+		return selector;
+	}
+
+	void writeTo(QueueEntryBase *destination) {
+		entry.moveTo(destination);
+	}
+
+	/*
+	 * Moving plain data is copying it.
+	 */
+	void writePlainTo(QueueEntryBase *destination, size_t plainEntrySize) {
+		copyPlainEntry(entry, destination, plainEntrySize);
+	}
+};
+
+/*
+ * Constructs an entry of type T directly in the slot, using a functor that takes the address
+ * at which to construct the entry and returns the entry constructed.
+ *
+ * When the slot holds an entry of exactly type T, the entry in the slot is destroyed and constructed again in its place.
+ * Otherwise, such as when the slot holds a base type of T, or when the data array has a payload arena
+ * which the entry constructed would not have, the entry is constructed on the stack and moved into the slot.
+ *
+ * The slot is selected by the type tag of T, see TaggedSlotSelector.
+ * T must be default constructible, as are all types held by data arrays.
+ */
+template <typename T, typename Constructor>
+class QueueEntryEmplacer : public QueueEntryWriter {
+	Constructor &construct;
+
+	TaggedSlotSelector<T> selector;
+
+public:
+	QueueEntryEmplacer(Constructor &construct) : construct(construct) {}
+
+	SlotSelector &getSelector() {
+		return selector;
+	}
+
+	void writeTo(QueueEntryBase *destination) {
+		if(typeid(*destination) != typeid(T)) {
+			writeTo(destination, NULL);
+		} else {
+			T *slotEntry = static_cast<T *>(destination);
+			slotEntry->~T();
+			try {
+				construct(slotEntry);
+			} catch(...) {
+				/* the slot must always hold a valid entry */
+				new (slotEntry) T();
+				throw;
+			}
+		}
+	}
+
+	/*
+	 * The entry in the slot is kept rather than constructed again, so that it keeps its arena for the entries written
+	 * to the slot later, and the new entry is moved into it.
+	 */
+	void writeTo(QueueEntryBase *destination, PayloadArena *) {
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+		T *entry = construct(&storage);
+		entry->moveTo(destination);
+		entry->~T();
+	}
+};
+
+}
+
+#endif /* QUEUE_QUEUEENTRYWRITER_H_ */
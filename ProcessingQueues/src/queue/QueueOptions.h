@@ -0,0 +1,136 @@
+/*
+ * QueueOptions.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_QUEUEOPTIONS_H_
+#define QUEUE_QUEUEOPTIONS_H_
+
+#include "threading/CpuSet.h"
+#include "threading/WaitStrategy.h"
+
+namespace hpqueue {
+
+/**
+ * Selects the algorithms used by a queue.
+ *
+ * The defaults match the original behaviour of the queues, so that the alternatives
+ * can be enabled individually and compared against them.
+ */
+struct QueueOptions {
+	/*
+	 * When true, multiple writers claim slots with an atomic compare-and-swap on the queue's claim index
+	 * instead of serializing on a mutex.  Claimed slots are published to readers in the order they were claimed.
+	 */
+	bool lockFreeWriters;
+
+	/*
+	 * When true, multiple readers of a SyncQueue claim slots by advancing a shared ticket with an atomic compare-and-swap,
+	 * instead of moving to the front of a mutex-protected list of readers.
+	 * A reader releases its slots once it has handled their entries, and the queue's read index is advanced past the
+	 * released slots without a mutex.
+	 */
+	bool lockFreeReaders;
+
+	/*
+	 * When true, queue sizes are rounded up to powers of two, so that indices wrap around with a mask rather than
+	 * an integer division.  Queue growth doubles the size, which keeps it a power of two.
+	 */
+	bool powerOfTwoSize;
+
+	/*
+	 * When true, a full SyncQueue grows without pausing its readers and writers.
+	 * Rather than copying the entries to a larger queue, writers move on to a new, larger generation of the queue,
+	 * while readers finish reading the older generation before moving on to the new one.
+	 * The older generation is deleted once no thread can still be using it.
+	 * This mode uses lock-free readers and writers, whatever the settings of lockFreeReaders and lockFreeWriters.
+	 */
+	bool onlineResize;
+
+	/*
+	 * When non-zero, a full SyncQueue grows by linking a new segment of this many slots, rather than a generation twice the size,
+	 * and continues to link segments until the segments hold the max queue size.
+	 * As with online resizing, nothing is copied and readers and writers are not paused.
+	 * Segments that have been read are kept on a free list for reuse rather than deleted.
+	 * The first segment has the queue's initial size.
+	 */
+	unsigned int segmentSize;
+
+	/*
+	 * When non-zero, a queue that has grown shrinks back down, a half at a time, when its occupancy stays below
+	 * this percentage of its size for shrinkPeriodMillis.  The queue never shrinks below its initial size.
+	 * The watermark should be well below 50, so that a queue that shrinks is not soon full again.
+	 * Shrinking pauses producers and consumers as growing does, so it does not apply with online resizing or segments.
+	 * The occupancy is sampled by a thread of the processor's own, a few times each period.
+	 */
+	unsigned int shrinkLowWatermark;
+
+	unsigned int shrinkPeriodMillis;
+
+	/*
+	 * The largest number of entries a consumer worker removes from the queue at once.
+	 * Each worker sizes its batches from the current depth of the queue, up to this limit,
+	 * so batches stay small while the queue is shallow and grow as the queue backs up.
+	 * The default of 1 removes entries one at a time.
+	 */
+	unsigned int maxRemoveBatchSize;
+
+	/*
+	 * When not negative, the queue's slots are bound to this NUMA node, whichever thread grows the queue,
+	 * and a queue processor pins its consumer workers to the node's CPUs, so that consumers read entries from local memory.
+	 * The queue object itself, including its stats, is placed wherever the processor is allocated,
+	 * so to place it on the node as well, create the processor from a thread pinned to the node.
+	 */
+	int numaNode;
+
+	/*
+	 * When not empty, a queue processor pins its consumer workers to these CPUs rather than to the CPUs of numaNode.
+	 */
+	pthreadWrapper::CpuSet workerCpus;
+
+	/*
+	 * How a queue processor's consumer workers wait for entries when the queue is empty.
+	 * The default sleeps on a condition, which each add must signal with a mutex.  Spinning wakes quickest,
+	 * and suits workers pinned to dedicated cores, while parking on a futex costs an add nothing while the worker is awake.
+	 */
+	pthreadWrapper::WaitStrategy waitStrategy;
+
+	/*
+	 * When either is non-zero, the wakeups of a queue processor's waiting consumer workers are coalesced:
+	 * an add wakes a worker when the queue becomes non-empty, and then, while workers remain waiting,
+	 * only once doorbellMaxAdds entries have been added or doorbellMaxMicros have passed since a worker was last woken.
+	 * The worker woken removes the entries added in between, so a producer adding entries quickly pays for far fewer wakeups.
+	 * Coalescing requires that any worker can remove any entry, so it applies only with lockFreeReaders,
+	 * online resizing or segments, see WakeupDoorbell.
+	 */
+	unsigned int doorbellMaxAdds;
+
+	unsigned int doorbellMaxMicros;
+
+	/*
+	 * When true, a SyncQueue or ReaderWriterQueue creates an eventfd that becomes readable when the queue becomes
+	 * non-empty, so that a thread running an epoll or io_uring event loop can remove entries as they arrive
+	 * without a consumer worker, see ReaderWriterQueue::getReadinessFd.
+	 * The eventfd is specific to Linux, so on other platforms the queue has no readiness eventfd.
+	 */
+	bool readinessEventFd;
+
+	QueueOptions() :
+		lockFreeWriters(false),
+		lockFreeReaders(false),
+		powerOfTwoSize(false),
+		onlineResize(false),
+		segmentSize(0),
+		shrinkLowWatermark(0),
+		shrinkPeriodMillis(1000),
+		maxRemoveBatchSize(1),
+		numaNode(-1),
+		doorbellMaxAdds(0),
+		doorbellMaxMicros(0),
+		readinessEventFd(false) {}
+};
+
+}
+
+#endif /* QUEUE_QUEUEOPTIONS_H_ */
@@ -0,0 +1,48 @@
+/*
+ * QueueReservation.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_QUEUERESERVATION_H_
+#define QUEUE_QUEUERESERVATION_H_
+
+#include <stddef.h>
+
+#include "QueueEntryBase.h"
+
+namespace hpqueue {
+
+class ReaderWriterQueue;
+
+/**
+ * A queue slot reserved by a writer, to be populated in place and then committed, or else aborted.
+ *
+ * The slot is not visible to readers until it is committed.  Slots are made visible in the order they were reserved,
+ * so a writer should populate a reserved slot promptly, since writers that reserve after it cannot commit before it does.
+ */
+struct QueueReservation {
+	/* the entry in the reserved slot, to be populated before committing */
+	QueueEntryBase *entry;
+
+	int index;
+
+	int nextIndex;
+
+	/* the queue holding the slot, which with online resizing is a generation of the queue the slot was reserved from */
+	ReaderWriterQueue *queue;
+
+	/* with online resizing, the epoch the writer remains inside until it commits or aborts */
+	unsigned int epoch;
+
+	QueueReservation() :
+		entry(NULL),
+		index(-1),
+		nextIndex(-1),
+		queue(NULL),
+		epoch(0) {}
+};
+
+}
+
+#endif /* QUEUE_QUEUERESERVATION_H_ */
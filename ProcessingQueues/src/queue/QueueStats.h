@@ -25,18 +25,33 @@ class QueueStats {
 	/* entries previously handled and no longer in the queue */
 	unsigned int removedCount;
 
+	/* the times a waiting consumer worker was woken after an add */
+	unsigned int wakeupCount;
+
+	/* the adds with consumer workers waiting that woke none, as the wakeups were coalesced, see WakeupDoorbell */
+	unsigned int suppressedWakeupCount;
+
 	pthreadWrapper::Mutex outLock;
 
 public:
 	QueueStats(unsigned int size) :
 		size(size),
 		addedCount(0),
-		removedCount(0) {}
+		removedCount(0),
+		wakeupCount(0),
+		suppressedWakeupCount(0) {}
 
 	inline void incrementAddedCount() {
 		addedCount++;
 	}
 
+	/**
+	 * Increment the number of items that have been added to the queue when there is no lock between writers
+	 */
+	inline void incrementAddedCount(unsigned int increment) {
+		__sync_fetch_and_add(&addedCount, increment);
+	}
+
 	/**
 	 * Increment the number of items that have been removed from the queue to which these stats pertain
 	 */
@@ -52,6 +67,22 @@ public:
 		removedCount++;
 	}
 
+	inline void incrementWakeupCount(unsigned int increment) {
+		__sync_fetch_and_add(&wakeupCount, increment);
+	}
+
+	inline void incrementSuppressedWakeupCount() {
+		__sync_fetch_and_add(&suppressedWakeupCount, 1);
+	}
+
+	unsigned int getWakeupCount() {
+		return wakeupCount;
+	}
+
+	unsigned int getSuppressedWakeupCount() {
+		return suppressedWakeupCount;
+	}
+
 	void setSize(unsigned int newSize) {
 		size = newSize;
 	}
@@ -63,12 +94,18 @@ public:
 	void print(FILE *fp, const std::string &queueName) {
 		outLock.acquire();
 		fprintf(fp, "enqueued (handled) size: %d (%d) %d %s\n", addedCount - removedCount, removedCount, size, queueName.c_str());
+		if(wakeupCount || suppressedWakeupCount) {
+			fprintf(fp, "wakeups (suppressed): %u (%u) %s\n", wakeupCount, suppressedWakeupCount, queueName.c_str());
+		}
 		outLock.release();
 	}
 
 	void print(std::ostream& dout, const std::string &queueName) {
 		outLock.acquire();
 		dout << "enqueued (handled) size: " << addedCount - removedCount << " (" << removedCount << ") " << size  << " " << queueName << std::endl;
+		if(wakeupCount || suppressedWakeupCount) {
+			dout << "wakeups (suppressed): " << wakeupCount << " (" << suppressedWakeupCount << ") " << queueName << std::endl;
+		}
 		outLock.release();
 	}
 };
@@ -14,6 +14,8 @@
 
 namespace hpqueue {
 
+class SyncQueue;
+
 /**
  * ReaderIndex contains indicators that allow queue users to navigate through a queue.
  * Depending on the queue, different fields of this object are used.
@@ -27,6 +29,9 @@ struct ReaderIndex {
 	/* indicates the index of the queue to which this index object is assigned */
 	int index;
 
+	/* indicates the number of consecutive slots, starting at index, assigned to this object by a batch removal */
+	int count;
+
 	/* indicates whether the slot associated with index has been populated yet */
 	volatile bool isEmpty;
 
@@ -36,6 +41,12 @@ struct ReaderIndex {
 	/* indicates whether the queue is aware of this index */
 	bool inQueue;
 
+	/* for a queue that grows online, the generation of the queue holding the slots assigned to this object */
+	SyncQueue *generation;
+
+	/* for a queue that grows online, the epoch entered while holding slots of the generation */
+	unsigned int epoch;
+
 	/* these three fields allow for a linked list of these objects */
 	ReaderIndex *previous;
 	ReaderIndex *next;
@@ -44,9 +55,12 @@ struct ReaderIndex {
 	ReaderIndex(int workerIdentifier) :
 		workerIdentifier(workerIdentifier),
 		index(-1),
+		count(1),
 		isEmpty(true),
 		isDone(false),
 		inQueue(false),
+		generation(NULL),
+		epoch(0),
 		previous(NULL),
 		next(NULL),
 		nextIndex(-1) {}
@@ -54,9 +68,12 @@ struct ReaderIndex {
 	ReaderIndex() :
 		workerIdentifier(-1),
 		index(-1),
+		count(1),
 		isEmpty(true),
 		isDone(false),
 		inQueue(false),
+		generation(NULL),
+		epoch(0),
 		previous(NULL),
 		next(NULL),
 		nextIndex(-1) {}
@@ -64,6 +81,7 @@ struct ReaderIndex {
 	void appendTo(std::string &str) {
 		str.append(" id: ").append(Data::getStringValue(workerIdentifier)).
 			append(" index: ").append(Data::getStringValue(index)).
+			append(" count: ").append(Data::getStringValue(count)).
 			append(" isEmpty: ").append(Data::getStringValue(isEmpty)).
 			append(" isDone: ").append(Data::getStringValue(isDone)).
 			append(" inQueue: ").append(Data::getStringValue(inQueue));
@@ -5,18 +5,73 @@
  *      Author: sfoley
  */
 
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
 #include "ReaderWriterQueue.h"
 
 using namespace std;
 
 namespace hpqueue {
 
+ReaderWriterQueue::~ReaderWriterQueue() {
+	if(readinessFd >= 0) {
+		close(readinessFd);
+	}
+}
+
+int ReaderWriterQueue::createReadinessFd(const QueueOptions &options) {
+#ifdef __linux__
+	if(options.readinessEventFd) {
+		return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	}
+#endif
+	/* eventfd is specific to Linux, so elsewhere there is no readiness eventfd */
+	return -1;
+}
+
+void ReaderWriterQueue::notifyReadiness() {
+#ifdef __linux__
+	/* orders the entries added before the check of whether a reader armed the eventfd, pairing with the fence in armReadiness */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(readinessArmed.load(std::memory_order_relaxed) && readinessArmed.exchange(false, std::memory_order_relaxed)) {
+		UINT_64 value = 1;
+		if(write(readinessFd, &value, sizeof(value)) < 0) {
+			/* the counter cannot overflow with one write per arming, so the eventfd is readable already */
+		}
+	}
+#endif
+}
+
+bool ReaderWriterQueue::armReadiness(ReaderIndex &readerIndex) {
+#ifdef __linux__
+	if(readinessFd >= 0) {
+		UINT_64 value;
+		if(read(readinessFd, &value, sizeof(value)) < 0) {
+			/* the eventfd was not readable, there is nothing to clear */
+		}
+		readinessArmed.store(true, std::memory_order_relaxed);
+		/* orders arming before the check for entries, so that an add either sees the eventfd armed or its entry is seen here */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+#endif
+	return isEmpty(readerIndex);
+}
+
 int ReaderWriterQueue::isFull() {
 	/* The slot just before the current read index is in use by the reader until it reads another */
-	int next = nextIndex(writeIndex);
-	if(next == readIndex) {
-		/* queue is full, cannot write */
-		return IS_FULL;
+	int next = nextIndex(writeIndex.load(std::memory_order_relaxed));
+	if(next == cachedReadIndex) {
+		/* the queue looked full the last time we checked, so see how far the reader has moved since then */
+		cachedReadIndex = readIndex.load(std::memory_order_acquire);
+		if(next == cachedReadIndex) {
+			/* queue is full, cannot write */
+			return IS_FULL;
+		}
 	}
 	return next;
 }
@@ -24,57 +79,220 @@ int ReaderWriterQueue::isFull() {
 
 void ReaderWriterQueue::insert(QueueEntryBase &entry, QueueEntryBase *destination, QueueEntryBase *&destinationPtr) {
 	destinationPtr = destination;
-	entry.copyTo(destination);
+	if(plainEntrySize) {
+		std::memcpy(static_cast<void *>(destination), static_cast<const void *>(&entry), plainEntrySize);
+	} else {
+		entry.copyTo(destination);
+	}
+}
+
+void ReaderWriterQueue::relocate(QueueEntryBase &entry, QueueEntryBase *destination, QueueEntryBase *&destinationPtr) {
+	destinationPtr = destination;
+	entry.moveTo(destination);
 }
 
-bool ReaderWriterQueue::insert(QueueEntryBase &entry) {
-	if(dataEntries->isCompatibleEntry(entry)) {
-		QueueEntryBase *queueEntry = dataEntries->getQueueEntry(writeIndex, entry);
-		if(queueEntry) {
-			insert(entry, queueEntry, queueData[writeIndex]);
-			return true;
+void ReaderWriterQueue::relocateRun(QueueEntryBase **oldQueueData, QueueData *oldEntries, int oldIndex, QueueEntryBase **newQueueData, int newIndex, int count) {
+	if(plainEntrySize && count > 0) {
+		dataEntries->copyEntries(oldEntries, oldIndex, newIndex, count);
+	}
+	for(int i=0; i<count; i++) {
+		QueueEntryBase *oldEntry = oldQueueData[oldIndex + i];
+		/*
+		 * A slot holding the null entry, such as one given up by an aborted reservation or a failed add,
+		 * stays null, even in data arrays that would give the null entry a slot of their own type.
+		 */
+		QueueEntryBase *newEntry = (oldEntry == &QueueEntryBase::nullEntry) ? NULL : dataEntries->getQueueEntry(newIndex + i, *oldEntry);
+		if(!newEntry) {
+			newQueueData[newIndex + i] = &QueueEntryBase::nullEntry;
+		} else if(plainEntrySize) {
+			newQueueData[newIndex + i] = newEntry;
+		} else {
+			relocate(*oldEntry, newEntry, newQueueData[newIndex + i]);
 		}
 	}
+}
+
+bool ReaderWriterQueue::insert(QueueEntryBase &entry, int index) {
+	QueueEntryBase *queueEntry = dataEntries->getQueueEntry(index, entry);
+	if(queueEntry) {
+		insert(entry, queueEntry, queueData[index]);
+		return true;
+	}
+	return false;
+}
+
+bool ReaderWriterQueue::insert(QueueEntryWriter &writer, int index) {
+	QueueEntryBase *queueEntry = writer.getSelector().select(*dataEntries, index);
+	if(queueEntry) {
+		queueData[index] = queueEntry;
+		PayloadArena *payloadArena = dataEntries->getPayloadArena();
+		if(plainEntrySize) {
+			writer.writePlainTo(queueEntry, plainEntrySize);
+		} else if(payloadArena) {
+			writer.writeTo(queueEntry, payloadArena);
+		} else {
+			writer.writeTo(queueEntry);
+		}
+		return true;
+	}
 	return false;
 }
 
-int ReaderWriterQueue::tryInsert(QueueEntryBase &entry) {
+bool ReaderWriterQueue::insert(QueueEntryWriter &writer) {
+	return writer.getSelector().isCompatible(*dataEntries) && insert(writer, writeIndex.load(std::memory_order_relaxed));
+}
+
+unsigned int ReaderWriterQueue::insertBatch(QueueEntryBase *entries[], unsigned int count, int index) {
+	unsigned int inserted = 0;
+	for(unsigned int i=0; i<count; i++) {
+		if(insert(*entries[i], index)) {
+			inserted++;
+		} else {
+			queueData[index] = &QueueEntryBase::nullEntry;
+		}
+		index = nextIndex(index);
+	}
+	return inserted;
+}
+
+bool ReaderWriterQueue::isCompatibleBatch(QueueEntryBase *entries[], unsigned int count) {
+	for(unsigned int i=0; i<count; i++) {
+		if(!dataEntries->isCompatibleEntry(*entries[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ReaderWriterQueue::hasSpace(int currentWriteIndex, unsigned int count) {
+	if(getFreeSlots(currentWriteIndex, cachedReadIndex) < count) {
+		/* not enough space the last time we checked, so see how far the reader has moved since then */
+		cachedReadIndex = readIndex.load(std::memory_order_acquire);
+		return getFreeSlots(currentWriteIndex, cachedReadIndex) >= count;
+	}
+	return true;
+}
+
+int ReaderWriterQueue::tryInsert(QueueEntryWriter &writer) {
 	int nextIndex = isFull();
 	if(nextIndex == IS_FULL) {
 		return IS_FULL;
 	}
-	if(!insert(entry)) {
+	if(!insert(writer)) {
 		return CANNOT_ADD;
 	}
 	return nextIndex;
 }
 
-int ReaderWriterQueue::add(QueueEntryBase &entry) {
-	int nextIndex = tryInsert(entry);
+int ReaderWriterQueue::add(QueueEntryWriter &writer) {
+	int nextIndex = tryInsert(writer);
 	if(nextIndex < 0) {
 		return nextIndex;
 	}
-	int currentWriteIndex = writeIndex;
-	writeIndex = nextIndex;
+	int currentWriteIndex = writeIndex.load(std::memory_order_relaxed);
+	writeIndex.store(nextIndex, std::memory_order_release);
+	stats.incrementAddedCount();
+	signalReadiness();
+	return currentWriteIndex;
+}
+
+int ReaderWriterQueue::reserve(SlotSelector &selector, QueueReservation &reservation) {
+	if(!selector.isCompatible(*dataEntries)) {
+		return CANNOT_ADD;
+	}
+	int nextIndex = isFull();
+	if(nextIndex == IS_FULL) {
+		return IS_FULL;
+	}
+	int currentWriteIndex = writeIndex.load(std::memory_order_relaxed);
+	QueueEntryBase *queueEntry = selector.select(*dataEntries, currentWriteIndex);
+	if(!queueEntry) {
+		return CANNOT_ADD;
+	}
+	queueData[currentWriteIndex] = queueEntry;
+	reservation.entry = queueEntry;
+	reservation.index = currentWriteIndex;
+	reservation.nextIndex = nextIndex;
+	reservation.queue = this;
+	return currentWriteIndex;
+}
+
+void ReaderWriterQueue::commit(QueueReservation &reservation) {
+	writeIndex.store(reservation.nextIndex, std::memory_order_release);
 	stats.incrementAddedCount();
+	signalReadiness();
+}
+
+void ReaderWriterQueue::abort(QueueReservation & /* reservation */) {
+	/* the write index was never advanced, so the slot is written by the next add */
+}
+
+int ReaderWriterQueue::addBatch(QueueEntryBase *entries[], unsigned int count) {
+	if(!isCompatibleBatch(entries, count)) {
+		return CANNOT_ADD;
+	}
+	int currentWriteIndex = writeIndex.load(std::memory_order_relaxed);
+	if(!hasSpace(currentWriteIndex, count)) {
+		return IS_FULL;
+	}
+	unsigned int inserted = insertBatch(entries, count, currentWriteIndex);
+	writeIndex.store(advanceIndex(currentWriteIndex, count), std::memory_order_release);
+	stats.incrementAddedCount(inserted);
+	signalReadiness();
 	return currentWriteIndex;
 }
 
 bool ReaderWriterQueue::isEmpty(ReaderIndex &readerIndex) {
-	return (readerIndex.isEmpty = (readIndex == writeIndex));
+	int currentReadIndex = readIndex.load(std::memory_order_relaxed);
+	if(pendingReadCount) {
+		/* the slots of the last batch have already been read */
+		currentReadIndex = advanceIndex(currentReadIndex, pendingReadCount);
+	}
+	if(currentReadIndex == cachedWriteIndex) {
+		/* the queue looked empty the last time we checked, so see how far the writer has moved since then */
+		cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+	}
+	return (readerIndex.isEmpty = (currentReadIndex == cachedWriteIndex));
 }
 
 QueueEntryBase &ReaderWriterQueue::remove(ReaderIndex &readerIndex) {
+	releasePendingReads();
 	if(isEmpty(readerIndex)) {
 		/* queue is empty */
 		return QueueEntryBase::nullEntry;
 	}
-	readerIndex.index = readIndex;
-	QueueEntryBase &result = *queueData[readIndex];
-	readIndex = nextIndex(readIndex);
+	int currentReadIndex = readIndex.load(std::memory_order_relaxed);
+	readerIndex.index = currentReadIndex;
+	readerIndex.count = 1;
+	QueueEntryBase &result = *queueData[currentReadIndex];
+	readIndex.store(nextIndex(currentReadIndex), std::memory_order_release);
 	return result;
 }
 
+/*
+ * As with remove, the read index is moved one past the first slot of the batch, which keeps that slot from being written
+ * (the slot just below the read index is never written, since a write there would make the queue look empty).
+ * The remaining slots of the batch lie at and above the read index, so they are not writable either.
+ * They are released when the reader returns for more entries.
+ */
+unsigned int ReaderWriterQueue::removeBatch(ReaderIndex &readerIndex, QueueEntryBase *entries[], unsigned int maxCount) {
+	releasePendingReads();
+	if(maxCount == 0 || isEmpty(readerIndex)) {
+		return 0;
+	}
+	int currentReadIndex = readIndex.load(std::memory_order_relaxed);
+	unsigned int available = ((cachedWriteIndex > currentReadIndex) ? cachedWriteIndex : (int) currentSize) - currentReadIndex;
+	unsigned int count = std::min(available, maxCount);
+	for(unsigned int i = 0; i < count; i++) {
+		entries[i] = queueData[currentReadIndex + i];
+	}
+	readerIndex.index = currentReadIndex;
+	readerIndex.count = count;
+	pendingReadCount = count - 1;
+	readIndex.store(nextIndex(currentReadIndex), std::memory_order_release);
+	return count;
+}
+
 /*
  * We move the front of the queue to the new section:
  * We have:
@@ -90,7 +308,11 @@ QueueEntryBase &ReaderWriterQueue::remove(ReaderIndex &readerIndex) {
  * Y* Y  Y  Y  Y  Y  X  E  E  E  E  E
  */
 void ReaderWriterQueue::resize(unsigned int size) {
-	if(currentSize >= size) {
+	if(currentSize > size) {
+		shrink(size);
+		return;
+	}
+	if(currentSize == size) {
 		return;
 	}
 	QueueEntryBase **newQueueData = new QueueEntryBase *[size];
@@ -102,23 +324,56 @@ void ReaderWriterQueue::resize(unsigned int size) {
 
 	int adjustment = size - oldSize;
 
-	for(int i=readIndex; adjustIndexForComparison(i) < adjustIndexForComparison(writeIndex); i = nextIndex(i, oldSize)) {
-		int newIndex = i;
-		if(i > writeIndex) {
-			newIndex += adjustment;
-		}
-
-		QueueEntryBase *oldEntry = oldQueueData[i];
-		QueueEntryBase *newEntry = dataEntries->getQueueEntry(newIndex, *oldEntry);
-		if(newEntry) {
-			insert(*oldEntry, newEntry, newQueueData[newIndex]);
-		} else {
-			newQueueData[newIndex] = &QueueEntryBase::nullEntry;
-		}
+	int oldReadIndex = readIndex;
+	int oldWriteIndex = writeIndex;
+	if(oldReadIndex <= oldWriteIndex) {
+		relocateRun(oldQueueData, oldEntries, oldReadIndex, newQueueData, oldReadIndex, oldWriteIndex - oldReadIndex);
+	} else {
+		/* the slots from the read index to the end move to the end of the new section, the slots before the write index stay */
+		relocateRun(oldQueueData, oldEntries, oldReadIndex, newQueueData, oldReadIndex + adjustment, oldSize - oldReadIndex);
+		relocateRun(oldQueueData, oldEntries, 0, newQueueData, 0, oldWriteIndex);
 	}
 	if(readIndex >= writeIndex + 1) {
-		readIndex += adjustment;
+		readIndex.store(readIndex + adjustment, std::memory_order_relaxed);
+	}
+	/* the indices were moved, so the copies of them are refreshed */
+	cachedReadIndex = readIndex;
+	cachedWriteIndex = writeIndex;
+	delete[] oldQueueData;
+	dataEntries->deleteEntries(oldEntries);
+	stats.setSize(size);
+}
+
+void ReaderWriterQueue::shrink(unsigned int size) {
+	size = getInitialSize(size, powerOfTwoSize);
+	if(size >= currentSize || getUsedSlots() >= size) {
+		/* one slot is always left unused, so the slots in use must number fewer than the new size */
+		return;
+	}
+	QueueEntryBase **newQueueData = new QueueEntryBase *[size];
+	QueueEntryBase **oldQueueData = queueData;
+	QueueData *oldEntries = dataEntries->resize(size);
+	int oldSize = currentSize;
+	int oldWriteIndex = writeIndex;
+	queueData = newQueueData;
+	currentSize = size;
+
+	/* the populated slots are moved in order to the start of the queue */
+	int oldReadIndex = readIndex;
+	int newIndex = 0;
+	if(oldReadIndex <= oldWriteIndex) {
+		newIndex = oldWriteIndex - oldReadIndex;
+		relocateRun(oldQueueData, oldEntries, oldReadIndex, newQueueData, 0, newIndex);
+	} else {
+		newIndex = oldSize - oldReadIndex;
+		relocateRun(oldQueueData, oldEntries, oldReadIndex, newQueueData, 0, newIndex);
+		relocateRun(oldQueueData, oldEntries, 0, newQueueData, newIndex, oldWriteIndex);
+		newIndex += oldWriteIndex;
 	}
+	readIndex.store(0, std::memory_order_relaxed);
+	writeIndex.store(newIndex, std::memory_order_relaxed);
+	cachedReadIndex = 0;
+	cachedWriteIndex = newIndex;
 	delete[] oldQueueData;
 	dataEntries->deleteEntries(oldEntries);
 	stats.setSize(size);
@@ -8,8 +8,12 @@
 #ifndef READERWRITERQUEUE_H_
 #define READERWRITERQUEUE_H_
 
+#include <atomic>
+
 #include "ProcessingQueue.h"
 #include "QueueConstants.h"
+#include "QueueOptions.h"
+#include "QueueReservation.h"
 #include "QueueStats.h"
 #include "threading/Mutex.h"
 
@@ -54,6 +58,13 @@ namespace hpqueue {
  * In the example, this means the slots at indices 2 to 15 have been copied to the end of the new queue section.
  * The remaining slots in the old queue remain at the same index in the resized queue.
  * The next slot for writing remains at index 1, while the next slot for reading is now at index 12.
+ *
+ * The read index is written only by the reader and the write index only by the writer.  Each is kept on its own cache line,
+ * together with a private copy of the other side's index.  The writer only reloads the read index when the queue looks full
+ * according to its copy, and the reader only reloads the write index when the queue looks empty according to its copy,
+ * so that the reader and writer touch each other's cache line only when they must.
+ * Stores to either index use release ordering and the loads of the other side's index use acquire ordering,
+ * so that the slot contents written (or read) before an index is advanced are visible to the other side.
  */
 class ReaderWriterQueue: public ProcessingQueue, public QueueConstants {
 	friend class SyncReaderList; //for access to readIndex
@@ -64,15 +75,51 @@ protected:
 	 */
 	QueueStats stats;
 
+	char readerPadding[CACHE_LINE_SIZE];
+
 	/*
 	 * indicates the index above the current lowest index being read (an index which is therefore non-writable)
 	 */
-	volatile int readIndex;
+	std::atomic<int> readIndex;
+
+	/*
+	 * the reader's copy of writeIndex, which may lag behind writeIndex
+	 */
+	int cachedWriteIndex;
+
+	/*
+	 * the number of slots at readIndex and above that belong to the reader's last batch and are not yet released for writing
+	 */
+	unsigned int pendingReadCount;
+
+	char writerPadding[CACHE_LINE_SIZE];
 
 	/*
 	 * indicates the next index to write
 	 */
-	volatile int writeIndex;
+	std::atomic<int> writeIndex;
+
+	/*
+	 * the writer's copy of readIndex, which may lag behind readIndex
+	 */
+	int cachedReadIndex;
+
+	/*
+	 * the number of bytes to memcpy when copying an entry into a slot, or 0 if the data entries do not hold plain data
+	 */
+	const size_t plainEntrySize;
+
+	/*
+	 * the eventfd signalled when the queue becomes non-empty, or -1, see getReadinessFd
+	 */
+	int readinessFd;
+
+	/*
+	 * true when a reader has found the queue empty and the next add is to signal readinessFd, see armReadiness
+	 */
+	std::atomic<bool> readinessArmed;
+
+	char endPadding[CACHE_LINE_SIZE];
 
 	pthreadWrapper::Mutex *stdoutLock;
 
@@ -82,20 +129,69 @@ protected:
 	void insert(QueueEntryBase &, QueueEntryBase *, QueueEntryBase *&);
 
 	/*
-	 * Determines where the data should be stored and performs the actual data copying for an add operation.
+	 * Moves an entry from a slot of the queue to a new slot when the queue is resized, rather than copying it.
+	 */
+	void relocate(QueueEntryBase &, QueueEntryBase *, QueueEntryBase *&);
+
+	/*
+	 * Relocates count consecutive slots starting at oldIndex of the old slots to consecutive slots starting at newIndex
+	 * when the queue is resized.  Slots of plain data entries are copied together with a single memcpy.
+	 */
+	void relocateRun(QueueEntryBase **oldQueueData, QueueData *oldEntries, int oldIndex, QueueEntryBase **newQueueData, int newIndex, int count);
+
+	/*
+	 * Determines where the data should be stored at the given index and performs the actual data copying for an add operation.
+	 * The caller must have already checked that the entry is compatible with the queue data entries.
+	 */
+	bool insert(QueueEntryBase &, int index);
+
+	/*
+	 * Determines where the data should be stored at the given index and populates the slot with the writer.
+	 * The caller must have already checked that the entry is compatible with the queue data entries.
+	 */
+	bool insert(QueueEntryWriter &, int index);
+
+	/*
+	 * Determines where the data should be stored and populates the slot with the writer for an add operation.
+	 */
+	bool insert(QueueEntryWriter &);
+
+	/*
+	 * Copies a batch of entries into consecutive slots starting at index, returning the number of entries copied.
+	 * Slots for entries that cannot be stored are populated with the null entry, which readers skip.
+	 */
+	unsigned int insertBatch(QueueEntryBase *entries[], unsigned int count, int index);
+
+	/*
+	 * Returns true if all the entries can be stored within this queue.
 	 */
-	bool insert(QueueEntryBase &);
+	bool isCompatibleBatch(QueueEntryBase *entries[], unsigned int count);
 
 	/*
 	 * Inserts if the queue is not full.
 	 */
-	int tryInsert(QueueEntryBase &);
+	int tryInsert(QueueEntryWriter &);
+
+	/*
+	 * Returns whether there are count slots available for writing starting at the given write index.
+	 */
+	bool hasSpace(int writeIndex, unsigned int count);
 
 	/*
 	 * Returns -1 if the queue is full or the next write index otherwise.
 	 */
 	virtual int isFull();
 
+	/*
+	 * Releases the slots of the reader's previous batch for writing.
+	 */
+	inline void releasePendingReads() {
+		if(pendingReadCount) {
+			readIndex.store(advanceIndex(readIndex.load(std::memory_order_relaxed), pendingReadCount), std::memory_order_release);
+			pendingReadCount = 0;
+		}
+	}
+
 	inline int adjustIndexForComparison(int index, int readIndex) {
 		/* readIndex is considered the  base of the queue when doing comparisons of emptiness or fullness */
 		return (index < readIndex) ? (index + currentSize) : index;
@@ -105,6 +201,41 @@ protected:
 		return adjustIndexForComparison(index, readIndex);
 	}
 
+	/*
+	 * Returns the number of slots available for writing when the next slot to write is at writeIndex
+	 * and the next slot to read is at readIndex.
+	 */
+	inline unsigned int getFreeSlots(int writeIndex, int readIndex) {
+		/* one slot is always left unused to distinguish a full queue from an empty queue */
+		return currentSize - 1 - (adjustIndexForComparison(writeIndex, readIndex) - readIndex);
+	}
+
+	/*
+	 * Returns the number of slots from the read index onwards that are in use and must be kept when the queue shrinks.
+	 */
+	virtual unsigned int getUsedSlots() {
+		return getNumElements();
+	}
+
+	/*
+	 * Makes the queue smaller, moving the slots in use to the start of the queue.
+	 * The queue is left as it is if the slots in use would not fit.
+	 */
+	void shrink(unsigned int newSize);
+
+	/*
+	 * Called after entries are made visible to readers, signals the readiness eventfd if a reader armed it.
+	 */
+	inline void signalReadiness() {
+		if(readinessFd >= 0) {
+			notifyReadiness();
+		}
+	}
+
+	void notifyReadiness();
+
+	static int createReadinessFd(const QueueOptions &options);
+
 	bool debug;
 
 public:
@@ -112,15 +243,22 @@ public:
 			unsigned int queueSize,
 			ProcessingQueueDataArray *dataEntries,
 			pthreadWrapper::Mutex *stdoutLock,
-			bool deleteQueueData = false):
-		ProcessingQueue(queueSize, dataEntries, deleteQueueData),
-		stats(queueSize),
+			bool deleteQueueData = false,
+			const QueueOptions &options = QueueOptions()):
+		ProcessingQueue(queueSize, dataEntries, deleteQueueData, options.powerOfTwoSize, options.numaNode),
+		stats(currentSize),
 		readIndex(0),
+		cachedWriteIndex(0),
+		pendingReadCount(0),
 		writeIndex(0),
+		cachedReadIndex(0),
+		plainEntrySize(dataEntries->getPlainEntrySize()),
+		readinessFd(createReadinessFd(options)),
+		readinessArmed(true),
 		stdoutLock(stdoutLock),
 		debug(false) {}
 
-	virtual ~ReaderWriterQueue() {}
+	virtual ~ReaderWriterQueue();
 
 	/*
 	 * Attempts to add the data in entry to the queue.
@@ -129,7 +267,42 @@ public:
 	 * Otherwise, IS_FULL is returned if the queue is full,
 	 * or CANNOT_ADD is returned if the queue does not know how to store the given entry.
 	 */
-	virtual int add(QueueEntryBase &);
+	int add(QueueEntryBase &entry) {
+		QueueEntryCopier writer(entry);
+		return add(writer);
+	}
+
+	/*
+	 * As with adding an entry, but the slot is populated by the writer, see QueueEntryWriter.
+	 * The writer is used only if the add succeeds.
+	 */
+	virtual int add(QueueEntryWriter &);
+
+	/*
+	 * Reserves the next slot for an entry, selected by the selector, so that the entry can be populated in place.
+	 * Returns the queue index of the slot, with the reservation holding the entry in the slot,
+	 * or IS_FULL if the queue is full, or CANNOT_ADD if the queue does not know how to store the entry.
+	 * A successful reservation must be followed by either commit or abort, with no other add by the same writer in between.
+	 */
+	virtual int reserve(SlotSelector &selector, QueueReservation &reservation);
+
+	/*
+	 * Makes the populated entry in the reserved slot visible to readers.
+	 */
+	virtual void commit(QueueReservation &reservation);
+
+	/*
+	 * Gives up the reserved slot without adding an entry.
+	 */
+	virtual void abort(QueueReservation &reservation);
+
+	/*
+	 * Attempts to add a batch of entries to consecutive slots of the queue.  The batch is added in its entirety or not at all.
+	 * If there is space for the whole batch, the entries are copied and the queue index of the first entry is returned.
+	 * Otherwise, IS_FULL is returned if the queue does not have space for the whole batch,
+	 * or CANNOT_ADD is returned if the queue does not know how to store one of the entries.
+	 */
+	virtual int addBatch(QueueEntryBase *entries[], unsigned int count);
 
 	/*
 	 * Returns whether the queue is empty at a specific next read index,
@@ -141,13 +314,53 @@ public:
 
 	virtual QueueEntryBase &remove(ReaderIndex &);
 
+	/*
+	 * Removes up to maxCount entries occupying consecutive slots of the queue, storing them in entries.
+	 * Returns the number of entries removed, which is 0 when there is nothing to read.
+	 * The slots are not available for writing until the reader returns to the queue for more entries,
+	 * so the entries remain valid until then.
+	 * A batch never wraps around the end of the queue, so it may hold fewer entries than are available.
+	 */
+	virtual unsigned int removeBatch(ReaderIndex &, QueueEntryBase *entries[], unsigned int maxCount);
+
+	/*
+	 * Indicates the reader has finished with the entries it last removed.
+	 * This queue keeps the slots of those entries until the reader returns for more entries, so there is nothing to do here.
+	 */
+	virtual void release(ReaderIndex &) {}
+
+	/*
+	 * Makes the queue larger, or smaller if it is not using the slots that would be removed.
+	 * The queue must not be accessed by readers or writers during a resize.
+	 */
 	virtual void resize(unsigned int newSize);
 
+	/*
+	 * Returns the eventfd created with the readinessEventFd option, or -1 if there is none, as on platforms other than Linux.
+	 *
+	 * The eventfd becomes readable when an entry is added to the queue after a reader has found it empty
+	 * and armed the eventfd with armReadiness.  Adds while the queue is non-empty do not write to the eventfd,
+	 * so it is signalled once per transition from empty to non-empty, however fast entries are added.
+	 * The eventfd is non-blocking, and it is closed when the queue is deleted.
+	 */
+	int getReadinessFd() {
+		return readinessFd;
+	}
+
+	/*
+	 * For a reader using the readiness eventfd, called when the reader has removed all the entries it found.
+	 * Clears the eventfd and arms it to be signalled by the next add, then returns whether the queue is still empty.
+	 * When it returns false, entries arrived in the meantime and the reader continues to remove them,
+	 * otherwise the reader waits for the eventfd to become readable before removing entries again.
+	 */
+	bool armReadiness(ReaderIndex &readerIndex);
+
 	/**
 	 * This method is not synchronized (intentionally) and thus does not give an exact answer when the queue is being modified.
 	 */
-	int getNumElements() {
-		return writeIndex - readIndex;
+	virtual int getNumElements() {
+		int currentReadIndex = readIndex.load(std::memory_order_relaxed);
+		return adjustIndexForComparison(writeIndex.load(std::memory_order_relaxed), currentReadIndex) - currentReadIndex;
 	}
 
 	virtual void print(const std::string &prefix = "");
@@ -8,6 +8,8 @@
 #ifndef RESIZECONTROLS_H_
 #define RESIZECONTROLS_H_
 
+#include <atomic>
+
 #include "threading/Condition.h"
 
 namespace hpqueue {
@@ -47,6 +49,9 @@ namespace hpqueue {
  * 7. resumeAdders(): Afterwards, all threads are resumed, addingCount is incremented again to indicate the thread will
  * attempt queue access again, and the process repeats itself from 2.
  *
+ * A thread that reserves a queue slot continues to access the queue after step 2, until it commits the reservation.
+ * It calls addReservation as soon as the slot is reserved, before it stops counting itself in addingCount,
+ * and removeReservation once the reservation is committed or aborted.  A resize waits for the reservations as well.
  */
 class ResizeControls {
 	pthreadWrapper::Mutex resizeQueuesLock;
@@ -55,10 +60,13 @@ class ResizeControls {
 
 	bool resizing;
 
-	int addingCount;
+	std::atomic<int> addingCount;
+
+	/* the number of reserved queue slots not yet committed or aborted */
+	std::atomic<int> reservedCount;
 
 public:
-	ResizeControls() : resizing(false), addingCount(0) {}
+	ResizeControls() : resizing(false), addingCount(0), reservedCount(0) {}
 
 	virtual ~ResizeControls() {}
 
@@ -87,18 +95,21 @@ public:
 	 * It will decrement addingCount, therefore any further queue access can be done only if holding the resizing lock.
 	 */
 	bool checkFull(int index) {
-		bool isFull = (index == ReaderWriterQueue::IS_FULL);
+		if(index != ReaderWriterQueue::IS_FULL) {
+			/*
+			 * The lock is not needed to finish queue access.  A thread that has just reserved a slot must not wait for the lock,
+			 * since the thread holding the lock may be adding to the queue and waiting for the reservation to be committed.
+			 */
+			addingCount--;
+			return false;
+		}
 		resizeQueuesLock.acquire();
 		addingCount--;
-		if(isFull) {
-			while(resizing) {
-				isResizingCond.wait(resizeQueuesLock);
-			}
-			/* when full, we intentionally do not release the lock */
-		} else {
-			resizeQueuesLock.release();
+		while(resizing) {
+			isResizingCond.wait(resizeQueuesLock);
 		}
-		return isFull;
+		/* when full, we intentionally do not release the lock */
+		return true;
 	}
 
 	/*
@@ -123,11 +134,46 @@ public:
 	 * This function blocks until all queue-accessing threads have completed their access.
 	 */
 	void pauseAdders() {
-		while(addingCount) {//wait for other adders to pause
+		while(addingCount || reservedCount.load()) {//wait for other adders to pause, and for reserved slots to be committed
 			usleep(100);
 		}
 	}
 
+	/*
+	 * Called by a thread that has reserved a queue slot, while it is still counted in addingCount or holds the resizing lock.
+	 */
+	void addReservation() {
+		reservedCount.fetch_add(1);
+	}
+
+	void removeReservation() {
+		reservedCount.fetch_sub(1);
+	}
+
+	/*
+	 * Begins a resize that was not triggered by a full queue, such as shrinking the queue.
+	 * The caller must not be accessing the queue, as counted by addingCount.
+	 * Returns false if another resize is in progress, otherwise sets the resizing boolean, after which the caller
+	 * must call pauseAdders before resizing and endResize afterwards.
+	 */
+	bool startResize() {
+		resizeQueuesLock.acquire();
+		bool result = !resizing;
+		resizing = true;
+		resizeQueuesLock.release();
+		return result;
+	}
+
+	/*
+	 * Ends a resize begun by startResize, resuming any threads currently blocked from queue access.
+	 */
+	void endResize() {
+		resizeQueuesLock.acquire();
+		resizing = false;
+		isResizingCond.broadcast();
+		resizeQueuesLock.release();
+	}
+
 	/**
 	 * Sets the resizing boolean to false, and resumes any threads currently blocked from queue access.
 	 *
@@ -0,0 +1,91 @@
+/*
+ * ShrinkPolicy.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_SHRINKPOLICY_H_
+#define QUEUE_SHRINKPOLICY_H_
+
+#include <sys/time.h>
+#include <algorithm>
+
+#include "base/primitiveTypes.h"
+
+namespace hpqueue {
+
+/**
+ * Decides when a queue that grew to absorb a burst should step back down in size.
+ *
+ * The queue shrinks to half its size once it has been occupied below the low watermark for the whole of the period.
+ * The period then starts over, so a queue steps down one half at a time, and it never shrinks below its initial size.
+ *
+ * There is hysteresis between shrinking and growing: a queue occupied below the low watermark is less than half full
+ * once halved, well short of the full queue that makes it grow again.  A queue that grows starts the period over.
+ *
+ * The policy is not synchronized, callers must ensure only one thread uses it at a time.
+ */
+class ShrinkPolicy {
+	/* the occupancy, as a percentage of the queue size, below which the queue may shrink, or 0 to never shrink */
+	unsigned int lowWatermark;
+
+	unsigned int periodMillis;
+
+	unsigned int minimumSize;
+
+	/* the time at which the occupancy was first seen below the low watermark, or -1 if it was not below the watermark when last checked */
+	INT_64 lowSince;
+
+	static INT_64 getCurrentMillis() {
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		return ((INT_64) now.tv_sec) * 1000 + now.tv_usec / 1000;
+	}
+
+public:
+	ShrinkPolicy(unsigned int lowWatermark, unsigned int periodMillis, unsigned int minimumSize) :
+		lowWatermark(lowWatermark),
+		periodMillis(periodMillis),
+		minimumSize(minimumSize),
+		lowSince(-1) {}
+
+	bool isEnabled() {
+		return lowWatermark > 0;
+	}
+
+	/*
+	 * Called when the queue grows, so that the queue stays at its new size for at least a full period.
+	 */
+	void reset() {
+		lowSince = -1;
+	}
+
+	/*
+	 * Returns the size the queue should shrink to, given the number of entries in the queue and the current size,
+	 * or 0 if the queue should not shrink.
+	 */
+	unsigned int getShrunkSize(unsigned int numElements, unsigned int currentSize) {
+		if(!isEnabled() || currentSize <= minimumSize) {
+			return 0;
+		}
+		if(((UINT_64) numElements) * 100 >= ((UINT_64) currentSize) * lowWatermark) {
+			lowSince = -1;
+			return 0;
+		}
+		INT_64 now = getCurrentMillis();
+		if(lowSince < 0) {
+			lowSince = now;
+			return 0;
+		}
+		if(now - lowSince < periodMillis) {
+			return 0;
+		}
+		/* another full period must pass before the next step down */
+		lowSince = now;
+		return std::max(currentSize / 2, minimumSize);
+	}
+};
+
+}
+
+#endif /* QUEUE_SHRINKPOLICY_H_ */
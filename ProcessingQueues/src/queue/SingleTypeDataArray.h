@@ -8,42 +8,168 @@
 #ifndef QUEUE_SINGLETYPEDATAARRAY_H_
 #define QUEUE_SINGLETYPEDATAARRAY_H_
 
+#include <cstring>
+#include <typeinfo>
+#include <utility>
+
+#include "PlainDataEntry.h"
+#include "ProcessingQueueDataArray.h"
+#include "QueueEntryWriter.h"
+
 namespace hpqueue {
 
+/**
+ * Stores entries of a single type by value, one in each queue slot.
+ *
+ * Since every slot holds an entry of the same type, the slot for an entry is found without inspecting the entry's type,
+ * and an entry is compatible only when it is exactly of type QueueType.
+ * When QueueType is a plain data entry, see PlainDataEntry, entries are copied into slots with memcpy.
+ */
 template <class QueueType>
 class SingleTypeDataArray : public ProcessingQueueDataArray {
 	struct SingleTypeQueueData : public QueueData {
 		QueueType bufferedData;
 
-		QueueType *getQueueEntry(QueueEntryBase &entry) {
+		QueueType *getQueueEntry(QueueEntryBase &) {
 			return &bufferedData;
 		}
+
+		QueueType *getTaggedEntry(unsigned int typeTag, PayloadArena *) {
+			return (typeTag == QueueEntryBase::getTypeTag<QueueType>()) ? &bufferedData : NULL;
+		}
 	};
 
+	bool isCompatibleEntry(QueueEntryBase &entry) {
+		return typeid(entry) == typeid(QueueType);
+	}
+
+	bool isCompatibleType(unsigned int typeTag) {
+		return typeTag == QueueEntryBase::getTypeTag<QueueType>();
+	}
+
 	QueueData &getEntry(unsigned int index) {
 		SingleTypeQueueData *entries = static_cast<SingleTypeQueueData *>(queueDataEntries);
 		return entries[index];
 	}
 
 	QueueData *resize(unsigned int queueSize) {
-		return ProcessingQueueDataArray::resize(queueSize, new SingleTypeQueueData[queueSize]);
+		SingleTypeQueueData *entries = allocateEntries<SingleTypeQueueData>(queueSize);
+		if(payloadArena) {
+			for(unsigned int i = 0; i < queueSize; i++) {
+				entries[i].bufferedData.setPayloadArena(payloadArena);
+			}
+		}
+		return ProcessingQueueDataArray::resize(queueSize, entries);
 	}
 
 	void deleteEntries(QueueData *entries) {
-		SingleTypeQueueData *dataEntries = static_cast<SingleTypeQueueData *>(entries);
-		delete [] dataEntries;
+		destroyEntries(static_cast<SingleTypeQueueData *>(entries));
 	}
 
 	unsigned int getEntrySize() {
 		return sizeof(SingleTypeQueueData);
 	}
 
+	size_t getPlainEntrySize() {
+		return PlainDataEntry<QueueType>::value ? sizeof(QueueType) : 0;
+	}
+
+	/*
+	 * Every slot holds an entry of exactly QueueType, so the slots differ only in the plain data of their entries.
+	 */
+	void copyEntries(QueueData *entries, unsigned int fromIndex, unsigned int toIndex, unsigned int count) {
+		SingleTypeQueueData *source = static_cast<SingleTypeQueueData *>(entries);
+		SingleTypeQueueData *destination = static_cast<SingleTypeQueueData *>(queueDataEntries);
+		std::memcpy(static_cast<void *>(destination + toIndex), static_cast<const void *>(source + fromIndex), count * sizeof(SingleTypeQueueData));
+	}
+
 public:
-	SingleTypeDataArray() {}
+	SingleTypeDataArray(unsigned int payloadArenaSize = 0, const SlotStoragePolicy &storagePolicy = SlotStoragePolicy()) :
+		ProcessingQueueDataArray(payloadArenaSize, storagePolicy) {}
 
 	virtual ~SingleTypeDataArray() {
 		deleteEntries(queueDataEntries);
 	}
+
+	/*
+	 * Returns the entry in the slot at the given index, which must be less than the current size.
+	 * Unlike getQueueEntry, no virtual call is needed to find the slot, see SingleTypeSlotSelector.
+	 */
+	QueueType *getSlot(unsigned int index) {
+		return &static_cast<SingleTypeQueueData *>(queueDataEntries)[index].bufferedData;
+	}
+};
+
+/*
+ * Selects the slot for an entry of type T in a given SingleTypeDataArray<T>, by indexing its slots directly.
+ */
+template <class T>
+class SingleTypeSlotSelector : public SlotSelector {
+	SingleTypeDataArray<T> &dataArray;
+
+public:
+	SingleTypeSlotSelector(SingleTypeDataArray<T> &dataArray) : dataArray(dataArray) {}
+
+	bool isCompatible(ProcessingQueueDataArray &dataEntries) {
+		return &dataEntries == &dataArray;
+	}
+
+	QueueEntryBase *select(ProcessingQueueDataArray &dataEntries, unsigned int index) {
+		return (&dataEntries == &dataArray) ? dataArray.getSlot(index) : NULL;
+	}
+};
+
+/*
+ * Copies an entry of type T into its slot of a given SingleTypeDataArray<T>, using the assignment operator of T itself
+ * rather than the virtual assignment operator of QueueEntryBase.  Plain data entries are copied the same way,
+ * since the assignment operator of a plain data type copies its bytes.
+ */
+template <class T>
+class SingleTypeEntryCopier : public QueueEntryWriter {
+	T &entry;
+
+	SingleTypeSlotSelector<T> selector;
+
+public:
+	SingleTypeEntryCopier(T &entry, SingleTypeDataArray<T> &dataArray) : entry(entry), selector(dataArray) {}
+
+	SlotSelector &getSelector() {
+		return selector;
+	}
+
+	void writeTo(QueueEntryBase *destination) {
+		*static_cast<T *>(destination) = entry;
+	}
+
+	void writePlainTo(QueueEntryBase *destination, size_t) {
+		*static_cast<T *>(destination) = entry;
+	}
+};
+
+/*
+ * Moves an entry of type T into its slot of a given SingleTypeDataArray<T>, see SingleTypeEntryCopier.
+ * The entry is copied when T has no move assignment operator.
+ */
+template <class T>
+class SingleTypeEntryMover : public QueueEntryWriter {
+	T &entry;
+
+	SingleTypeSlotSelector<T> selector;
+
+public:
+	SingleTypeEntryMover(T &entry, SingleTypeDataArray<T> &dataArray) : entry(entry), selector(dataArray) {}
+
+	SlotSelector &getSelector() {
+		return selector;
+	}
+
+	void writeTo(QueueEntryBase *destination) {
+		*static_cast<T *>(destination) = std::move(entry);
+	}
+
+	void writePlainTo(QueueEntryBase *destination, size_t) {
+		*static_cast<T *>(destination) = std::move(entry);
+	}
 };
 
 } /* namespace hpqueue */
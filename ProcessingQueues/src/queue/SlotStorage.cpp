@@ -0,0 +1,144 @@
+/*
+ * SlotStorage.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <new>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "SlotStorage.h"
+
+namespace hpqueue {
+
+static size_t roundUp(size_t size, size_t multiple) {
+	return ((size + multiple - 1) / multiple) * multiple;
+}
+
+static size_t getPageSize() {
+	static const size_t pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize;
+}
+
+/*
+ * Writes to each page of the mapping so that it is faulted in now rather than when the slots are first written.
+ */
+static void touchPages(void *base, size_t length) {
+	volatile char *pages = static_cast<volatile char *>(base);
+	for(size_t offset = 0; offset < length; offset += getPageSize()) {
+		pages[offset] = 0;
+	}
+}
+
+void *SlotStorage::map(size_t length, int flags, size_t alignment) {
+	/* a mapping is aligned to more than a page by mapping extra and unmapping what lies outside the aligned range */
+	size_t extra = (alignment > getPageSize()) ? alignment : 0;
+	void *mapping = mmap(NULL, length + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+	if(mapping == MAP_FAILED) {
+		return NULL;
+	}
+	if(extra == 0) {
+		return mapping;
+	}
+	char *start = static_cast<char *>(mapping);
+	char *aligned = reinterpret_cast<char *>(roundUp(reinterpret_cast<uintptr_t>(start), alignment));
+	if(aligned > start) {
+		munmap(start, aligned - start);
+	}
+	size_t tail = (start + length + extra) - (aligned + length);
+	if(tail > 0) {
+		munmap(aligned + length, tail);
+	}
+	return aligned;
+}
+
+void SlotStorage::bindToNode(void *mapping, size_t length, int numaNode) {
+#ifdef SYS_mbind
+	/* the mbind policy preferring a node, from numaif.h, which comes with libnuma rather than the C library */
+	static const int MPOL_PREFERRED_NODE = 1;
+	static const unsigned int MAX_NODES = 1024;
+	static const unsigned int BITS = 8 * sizeof(unsigned long);
+	if(numaNode >= 0 && (unsigned int) numaNode < MAX_NODES) {
+		unsigned long nodeMask[MAX_NODES / BITS] = {0};
+		nodeMask[numaNode / BITS] = 1UL << (numaNode % BITS);
+		/* the kernel reads one bit fewer than the number of bits given */
+		syscall(SYS_mbind, mapping, length, MPOL_PREFERRED_NODE, nodeMask, MAX_NODES + 1, 0);
+	}
+#endif
+}
+
+void *SlotStorage::allocate(size_t slotSize, unsigned int count, const SlotStoragePolicy &policy) {
+	size_t size = HEADER_SIZE + slotSize * count;
+	void *base = NULL;
+	size_t mappedLength = 0;
+	if(policy.pages == SlotStoragePolicy::HEAP_PAGES && policy.numaNode < 0) {
+		base = ::operator new(size);
+	} else {
+		/*
+		 * Advice and memory policies apply only to pages faulted after they are given,
+		 * so pages that are given them are touched afterwards rather than populated by the mapping.
+		 */
+		bool bound = (policy.numaNode >= 0);
+		int populate = 0;
+#ifdef MAP_POPULATE
+		if(policy.prefault && !bound) {
+			populate = MAP_POPULATE;
+		}
+#endif
+		bool populated = false;
+		/* huge pages are of no use to storage smaller than a huge page, which gets pages of the default size */
+		bool huge = (policy.pages == SlotStoragePolicy::TRANSPARENT_HUGE_PAGES || policy.pages == SlotStoragePolicy::EXPLICIT_HUGE_PAGES)
+				&& (size >= policy.hugePageSize);
+#ifdef MAP_HUGETLB
+		if(huge && policy.pages == SlotStoragePolicy::EXPLICIT_HUGE_PAGES) {
+			mappedLength = roundUp(size, policy.hugePageSize);
+			base = map(mappedLength, MAP_HUGETLB | populate, 0);
+			populated = (base && populate);
+		}
+#endif
+		if(!base && huge) {
+			mappedLength = roundUp(size, policy.hugePageSize);
+			base = map(mappedLength, 0, policy.hugePageSize);
+#ifdef MADV_HUGEPAGE
+			if(base) {
+				madvise(base, mappedLength, MADV_HUGEPAGE);
+			}
+#endif
+		}
+		if(!base) {
+			mappedLength = roundUp(size, getPageSize());
+			base = map(mappedLength, populate, 0);
+			populated = (populate != 0);
+		}
+		if(!base) {
+			throw std::bad_alloc();
+		}
+		if(bound) {
+			bindToNode(base, mappedLength, policy.numaNode);
+		}
+		if(policy.prefault && !populated) {
+			touchPages(base, mappedLength);
+		}
+	}
+	Header *header = static_cast<Header *>(base);
+	header->base = base;
+	header->mappedLength = mappedLength;
+	header->count = count;
+	return static_cast<char *>(base) + HEADER_SIZE;
+}
+
+void SlotStorage::release(void *storage) {
+	if(storage) {
+		Header &header = getHeader(storage);
+		if(header.mappedLength) {
+			munmap(header.base, header.mappedLength);
+		} else {
+			::operator delete(header.base);
+		}
+	}
+}
+
+} /* namespace hpqueue */
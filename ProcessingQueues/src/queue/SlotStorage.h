@@ -0,0 +1,120 @@
+/*
+ * SlotStorage.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef QUEUE_SLOTSTORAGE_H_
+#define QUEUE_SLOTSTORAGE_H_
+
+#include <stddef.h>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+namespace hpqueue {
+
+/**
+ * Selects the memory backing the slot arrays of a data array, see ProcessingQueueDataArray.
+ *
+ * A large queue that grows under load otherwise takes a page fault for each new page of slots, and a TLB miss
+ * for each page it touches afterwards, just when it is busiest.  Mapping the slots in huge pages means far fewer of both,
+ * and prefaulting has the kernel populate the mapping in one go when the slots are allocated.
+ */
+struct SlotStoragePolicy {
+	enum Pages {
+		/* slot arrays come from the heap */
+		HEAP_PAGES,
+
+		/* slot arrays are mapped with mmap, in pages of the default size */
+		MAPPED_PAGES,
+
+		/* slot arrays are mapped at a huge page boundary and advised with madvise(MADV_HUGEPAGE) to use transparent huge pages */
+		TRANSPARENT_HUGE_PAGES,
+
+		/*
+		 * slot arrays are mapped from the reserved huge page pool with MAP_HUGETLB,
+		 * falling back to transparent huge pages when the pool does not have enough free pages
+		 */
+		EXPLICIT_HUGE_PAGES
+	};
+
+	Pages pages;
+
+	/*
+	 * When true, mapped slot arrays are populated with MAP_POPULATE when allocated, rather than faulted in a page at a time
+	 * as the slots are constructed.
+	 */
+	bool prefault;
+
+	/*
+	 * The huge page size of the system, used to size and align huge page mappings.
+	 */
+	size_t hugePageSize;
+
+	/*
+	 * When not negative, slot arrays are mapped even with HEAP_PAGES, and their pages are bound to this NUMA node
+	 * with mbind before they are faulted, whichever thread allocates or first writes them.  The node is preferred
+	 * rather than required, so that the slots come from other nodes rather than failing when the node is out of memory.
+	 */
+	int numaNode;
+
+	SlotStoragePolicy(Pages pages = HEAP_PAGES, bool prefault = false, int numaNode = -1) :
+		pages(pages),
+		prefault(prefault),
+		hugePageSize(2 * 1024 * 1024),
+		numaNode(numaNode) {}
+};
+
+/**
+ * Allocates storage for arrays of slots according to a SlotStoragePolicy.
+ *
+ * The storage records how it was allocated, along with the number of slots, so that it can be released
+ * with nothing but the pointer, as with delete[].
+ */
+class SlotStorage {
+	struct Header {
+		/* the start of the heap allocation or mapping */
+		void *base;
+
+		/* the length of the mapping, or 0 for heap storage */
+		size_t mappedLength;
+
+		unsigned int count;
+	};
+
+	static Header &getHeader(void *storage) {
+		return *reinterpret_cast<Header *>(static_cast<char *>(storage) - HEADER_SIZE);
+	}
+
+	static void *map(size_t length, int flags, size_t alignment);
+
+	static void bindToNode(void *mapping, size_t length, int numaNode);
+
+public:
+	/* the header precedes the slots in a cache line of its own */
+	static const size_t HEADER_SIZE = CACHE_LINE_SIZE;
+
+	/*
+	 * Returns uninitialized storage for count slots of the given size.  Throws std::bad_alloc if no memory is available.
+	 */
+	static void *allocate(size_t slotSize, unsigned int count, const SlotStoragePolicy &policy);
+
+	static void release(void *storage);
+
+	static unsigned int getCount(void *storage) {
+		return getHeader(storage).count;
+	}
+
+	/*
+	 * Returns whether the storage was mapped rather than coming from the heap.
+	 */
+	static bool isMapped(void *storage) {
+		return getHeader(storage).mappedLength != 0;
+	}
+};
+
+} /* namespace hpqueue */
+
+#endif /* QUEUE_SLOTSTORAGE_H_ */
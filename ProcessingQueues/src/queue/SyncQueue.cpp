@@ -5,6 +5,9 @@
  *      Author: sfoley
  */
 
+#include <sched.h>
+#include <algorithm>
+
 #include "SyncQueue.h"
 
 using namespace std;
@@ -12,21 +15,213 @@ using namespace std;
 namespace hpqueue {
 
 
-int SyncQueue::add(QueueEntryBase &entry) {
+SyncQueue::~SyncQueue() {
+	if(onlineResize) {
+		for(std::vector<std::pair<SyncQueue *, unsigned int> >::iterator it = retiredGenerations.begin(); it != retiredGenerations.end(); it++) {
+			deleteGeneration(it->first);
+		}
+		for(std::vector<SyncQueue *>::iterator it = freeSegments.begin(); it != freeSegments.end(); it++) {
+			deleteGeneration(*it);
+		}
+		SyncQueue *generation = readGeneration.load(std::memory_order_relaxed);
+		while(generation) {
+			SyncQueue *next = generation->nextGeneration.load(std::memory_order_relaxed);
+			deleteGeneration(generation);
+			generation = next;
+		}
+	}
+	delete[] releasedSlots;
+}
+
+QueueOptions SyncQueue::getGenerationOptions(const QueueOptions &options) {
+	QueueOptions generationOptions = options;
+	if(options.onlineResize || options.segmentSize > 0) {
+		generationOptions.lockFreeReaders = generationOptions.lockFreeWriters = true;
+	}
+	return generationOptions;
+}
+
+int SyncQueue::add(QueueEntryWriter &writer) {
+	if(onlineResize) {
+		return addOnline(writer);
+	}
+	if(syncWriter) {
+		return SyncWriterQueue::add(writer);
+	}
+	return ReaderWriterQueue::add(writer);
+}
+
+int SyncQueue::reserve(SlotSelector &selector, QueueReservation &reservation) {
+	if(onlineResize) {
+		return reserveOnline(selector, reservation);
+	}
+	if(syncWriter) {
+		return SyncWriterQueue::reserve(selector, reservation);
+	}
+	return ReaderWriterQueue::reserve(selector, reservation);
+}
+
+void SyncQueue::commit(QueueReservation &reservation) {
+	if(onlineResize) {
+		SyncQueue *generation = static_cast<SyncQueue *>(reservation.queue);
+		generation->SyncWriterQueue::commit(reservation);
+		reclaimer.exit(reservation.epoch);
+		if(generation != this) {
+			/* the stats and the readiness eventfd of this queue cover all generations */
+			stats.incrementAddedCount(1);
+			signalReadiness();
+		}
+	} else if(syncWriter) {
+		SyncWriterQueue::commit(reservation);
+	} else {
+		ReaderWriterQueue::commit(reservation);
+	}
+}
+
+void SyncQueue::abort(QueueReservation &reservation) {
+	if(onlineResize) {
+		static_cast<SyncQueue *>(reservation.queue)->SyncWriterQueue::abort(reservation);
+		reclaimer.exit(reservation.epoch);
+	} else if(syncWriter) {
+		SyncWriterQueue::abort(reservation);
+	} else {
+		ReaderWriterQueue::abort(reservation);
+	}
+}
+
+int SyncQueue::addBatch(QueueEntryBase *entries[], unsigned int count) {
+	if(onlineResize) {
+		return addBatchOnline(entries, count);
+	}
 	if(syncWriter) {
-		return SyncWriterQueue::add(entry);
+		return SyncWriterQueue::addBatch(entries, count);
 	}
-	return ReaderWriterQueue::add(entry);
+	return ReaderWriterQueue::addBatch(entries, count);
+}
+
+std::atomic<bool> *SyncQueue::createReleasedSlots(unsigned int size) {
+	std::atomic<bool> *slots = new std::atomic<bool>[size];
+	for(unsigned int i = 0; i < size; i++) {
+		slots[i].store(false, std::memory_order_relaxed);
+	}
+	return slots;
+}
+
+unsigned int SyncQueue::claimReadSlots(ReaderIndex &readerIndex, unsigned int maxCount) {
+	INT_64 ticket = claimTicket.load(std::memory_order_relaxed);
+	while(true) {
+		int slot = getTicketSlot(ticket);
+		int currentWriteIndex = writeIndex.load(std::memory_order_acquire);
+		if(slot == currentWriteIndex) {
+			/* every populated slot has been claimed */
+			return 0;
+		}
+		/*
+		 * If the ticket is unchanged when we claim, then the slot has not been claimed by anyone else and was populated when
+		 * we loaded the write index.  Otherwise the compare-and-swap fails and gives us the current ticket to try again.
+		 * A batch does not wrap around the end of the queue, so that its entries are consecutive.
+		 */
+		unsigned int count = std::min(maxCount, (unsigned int) (((currentWriteIndex > slot) ? currentWriteIndex : (int) currentSize) - slot));
+		if(claimTicket.compare_exchange_weak(ticket, ticket + count, std::memory_order_relaxed)) {
+			readerIndex.index = slot;
+			readerIndex.count = count;
+			readerIndex.isDone = true;
+			return count;
+		}
+	}
+}
+
+void SyncQueue::release(ReaderIndex &readerIndex) {
+	if(onlineResize) {
+		releaseOnline(readerIndex);
+	} else if(lockFreeReaders) {
+		releaseSlots(readerIndex);
+	}
+}
+
+void SyncQueue::releaseSlots(ReaderIndex &readerIndex) {
+	if(!readerIndex.isDone) {
+		return;
+	}
+	readerIndex.isDone = false;
+	for(int i = 0; i < readerIndex.count; i++) {
+		releasedSlots[readerIndex.index + i].store(true);
+	}
+	advanceReadIndex();
+}
+
+/*
+ * Only the reader holding advancingReadIndex moves the read index or clears released slots, so the read index only moves forward
+ * and a released slot cannot be cleared once it has been reused.  A reader that finds another reader advancing does not wait for it.
+ * Instead, after giving up advancingReadIndex, the advancing reader checks whether the slot it stopped at was released in the meantime.
+ * Either that check sees the slot released, or the releasing reader sees advancingReadIndex available and advances the read index itself.
+ */
+void SyncQueue::advanceReadIndex() {
+	while(!advancingReadIndex.exchange(true, std::memory_order_acquire)) {
+		int currentReadIndex = readIndex.load(std::memory_order_relaxed);
+		int index = currentReadIndex;
+		while(releasedSlots[index].load(std::memory_order_acquire)) {
+			releasedSlots[index].store(false, std::memory_order_relaxed);
+			index = nextIndex(index);
+		}
+		if(index != currentReadIndex) {
+			readIndex.store(index, std::memory_order_release);
+		}
+		advancingReadIndex.store(false);
+		if(!releasedSlots[index].load()) {
+			break;
+		}
+	}
+}
+
+bool SyncQueue::hasUnclaimedSlots() {
+	int slot = getTicketSlot(claimTicket.load(std::memory_order_relaxed));
+	return slot != writeIndex.load(std::memory_order_acquire);
 }
 
 bool SyncQueue::isEmpty(ReaderIndex &readerIndex) {
+	if(onlineResize) {
+		unsigned int epoch = reclaimer.enter();
+		readerIndex.isEmpty = !getReadGeneration()->hasUnclaimedSlots();
+		reclaimer.exit(epoch);
+		return readerIndex.isEmpty;
+	}
+	if(lockFreeReaders) {
+		return (readerIndex.isEmpty = !hasUnclaimedSlots());
+	}
 	/*
 	 * When the queue readIndex is one above the writeIndex, the queue is full.
 	 * When the queue readIndex matches writeIndex, the queue is empty.
 	 * When the readIndex of the current thread matches or is below the the writeIndex,
 	 * but matches or is above the queue readIndex, then the thread's cell is empty.
 	 */
-	return (readerIndex.isEmpty = (adjustIndexForComparison(writeIndex) <= adjustIndexForComparison(readerIndex.index)));
+	int currentWriteIndex = writeIndex.load(std::memory_order_acquire);
+	return (readerIndex.isEmpty = (adjustIndexForComparison(currentWriteIndex) <= adjustIndexForComparison(readerIndex.index)));
+}
+
+bool SyncQueue::hasWorkFor(const ReaderIndex &readerIndex) {
+	if(onlineResize) {
+		/* unlike getReadGeneration, skips past the generations which have had all their slots claimed without retiring them */
+		unsigned int epoch = reclaimer.enter();
+		SyncQueue *generation = readGeneration.load(std::memory_order_acquire);
+		bool result = generation->hasUnclaimedSlots();
+		while(!result && (generation = generation->nextGeneration.load(std::memory_order_acquire))) {
+			result = generation->hasUnclaimedSlots();
+		}
+		reclaimer.exit(epoch);
+		return result;
+	}
+	if(lockFreeReaders) {
+		return hasUnclaimedSlots();
+	}
+	/*
+	 * The reader's slot is read without the index mutex, so that threads adding entries never wait for the readers.
+	 * Only the reader itself moves its slot while it runs, and other readers move it only when they leave the read list,
+	 * see SyncReaderList::remove, which they do when their workers stop, when every worker is signalled anyway.
+	 */
+	int index = *static_cast<const volatile int *>(&readerIndex.index);
+	int currentWriteIndex = writeIndex.load(std::memory_order_acquire);
+	return adjustIndexForComparison(currentWriteIndex) > adjustIndexForComparison(index);
 }
 
 QueueEntryBase &SyncQueue::removeSlot(ReaderIndex &readerIndex) {
@@ -41,6 +236,20 @@ QueueEntryBase &SyncQueue::removeSlot(ReaderIndex &readerIndex) {
 }
 
 QueueEntryBase &SyncQueue::remove(ReaderIndex &readerIndex) {
+	if(onlineResize) {
+		QueueEntryBase *entry;
+		if(removeOnline(readerIndex, &entry, 1)) {
+			return *entry;
+		}
+		return QueueEntryBase::nullEntry;
+	}
+	if(lockFreeReaders) {
+		releaseSlots(readerIndex);
+		if(claimReadSlots(readerIndex, 1)) {
+			return *queueData[readerIndex.index];
+		}
+		return QueueEntryBase::nullEntry;
+	}
 	/*
 	 * If our currently assigned slot has been populated,
 	 * readerIndex.isDone tells us whether it was previously handled.
@@ -61,19 +270,340 @@ QueueEntryBase &SyncQueue::remove(ReaderIndex &readerIndex) {
 	return QueueEntryBase::nullEntry;
 }
 
+unsigned int SyncQueue::removeBatch(ReaderIndex &readerIndex, QueueEntryBase *entries[], unsigned int maxCount) {
+	if(maxCount == 0) {
+		return 0;
+	}
+	if(onlineResize) {
+		return removeOnline(readerIndex, entries, maxCount);
+	}
+	if(lockFreeReaders) {
+		releaseSlots(readerIndex);
+		unsigned int count = claimReadSlots(readerIndex, maxCount);
+		for(unsigned int i = 0; i < count; i++) {
+			entries[i] = queueData[readerIndex.index + i];
+		}
+		return count;
+	}
+	if(readerIndex.isDone) {
+		if(!readList.moveToFront(readerIndex, maxCount)) {
+			/* just stay where we are, the back of the read list needs to move */
+			return 0;
+		}
+	}
+	/* the slots following the first slot of a batch were all populated when the batch was assigned */
+	QueueEntryBase &first = removeSlot(readerIndex);
+	if(!readerIndex.isDone) {
+		return 0;
+	}
+	entries[0] = &first;
+	for(int i = 1; i < readerIndex.count; i++) {
+		entries[i] = queueData[readerIndex.index + i];
+	}
+	return readerIndex.count;
+}
+
 void SyncQueue::resize(unsigned int size) {
+	if(onlineResize) {
+		unsigned int epoch = reclaimer.enter();
+		SyncQueue *generation = writeGeneration.load(std::memory_order_acquire);
+		if(size > generation->currentSize) {
+			grow(generation, size);
+		}
+		reclaimer.exit(epoch);
+		return;
+	}
 	int oldSize = currentSize;
 	int oldReadIndex = readIndex;
 	SyncWriterQueue::resize(size);
+	if(currentSize == (unsigned int) oldSize) {
+		return;
+	}
 
 	int adjustment = size - oldSize;
-	for(int i=oldReadIndex; adjustIndexForComparison(i, oldReadIndex) < adjustIndexForComparison(writeIndex, oldReadIndex); i = nextIndex(i, oldSize)) {
+	for(int i=oldReadIndex; adjustIndexForComparison(i, oldReadIndex) < adjustIndexForComparison(writeIndex, oldReadIndex); i = nextIndex(i, oldSize, powerOfTwoSize)) {
 		int newIndex = i;
 		if(i > writeIndex) {
 			newIndex += adjustment;
 		}
 	}
-	readList.adjust(adjustment, oldReadIndex);
+	if(lockFreeReaders) {
+		/*
+		 * Readers release their slots before pausing, so every claimed slot is below the read index,
+		 * and the next ticket belongs to the slot at the read index in the resized queue.
+		 */
+		delete[] releasedSlots;
+		releasedSlots = createReleasedSlots(currentSize);
+		ticketBase = claimTicket.load(std::memory_order_relaxed);
+		ticketSlot = readIndex.load(std::memory_order_relaxed);
+	} else if(currentSize < (unsigned int) oldSize) {
+		readList.rebase(oldReadIndex, oldSize);
+	} else {
+		readList.adjust(adjustment, oldReadIndex);
+	}
+}
+
+unsigned int SyncQueue::getUsedSlots() {
+	unsigned int usedSlots = SyncWriterQueue::getUsedSlots();
+	if(!lockFreeReaders && readList.front) {
+		int queueReadIndex = readIndex.load(std::memory_order_relaxed);
+		unsigned int readerSlots = adjustIndexForComparison(readList.front->index, queueReadIndex) - queueReadIndex + readList.front->count;
+		usedSlots = std::max(usedSlots, readerSlots);
+	}
+	return usedSlots;
+}
+
+bool SyncQueue::isResizable() {
+	if(onlineResize) {
+		/* the queue grows by itself when adding, so an add fails only when the queue has reached its max size */
+		return false;
+	}
+	return SyncWriterQueue::isResizable();
+}
+
+int SyncQueue::getNumElements() {
+	if(!onlineResize) {
+		return SyncWriterQueue::getNumElements();
+	}
+	unsigned int epoch = reclaimer.enter();
+	int count = 0;
+	SyncQueue *generation = readGeneration.load(std::memory_order_acquire);
+	do {
+		count += generation->ReaderWriterQueue::getNumElements();
+		generation = generation->nextGeneration.load(std::memory_order_acquire);
+	} while(generation);
+	reclaimer.exit(epoch);
+	return count;
+}
+
+int SyncQueue::addOnline(QueueEntryWriter &writer) {
+	unsigned int epoch = reclaimer.enter();
+	SyncQueue *generation;
+	int index;
+	do {
+		generation = writeGeneration.load(std::memory_order_acquire);
+		index = generation->SyncWriterQueue::add(writer);
+	} while(index == IS_FULL && grow(generation, 2));
+	reclaimer.exit(epoch);
+	if(index >= 0 && generation != this) {
+		/* the stats and the readiness eventfd of this queue cover all generations */
+		stats.incrementAddedCount(1);
+		signalReadiness();
+	}
+	return index;
+}
+
+int SyncQueue::reserveOnline(SlotSelector &selector, QueueReservation &reservation) {
+	unsigned int epoch = reclaimer.enter();
+	SyncQueue *generation;
+	int index;
+	do {
+		generation = writeGeneration.load(std::memory_order_acquire);
+		index = generation->SyncWriterQueue::reserve(selector, reservation);
+	} while(index == IS_FULL && grow(generation, 2));
+	if(index < 0) {
+		reclaimer.exit(epoch);
+	} else {
+		/* the writer stays inside the epoch until it commits or aborts */
+		reservation.epoch = epoch;
+	}
+	return index;
+}
+
+int SyncQueue::addBatchOnline(QueueEntryBase *entries[], unsigned int count) {
+	unsigned int epoch = reclaimer.enter();
+	SyncQueue *generation;
+	int index;
+	do {
+		generation = writeGeneration.load(std::memory_order_acquire);
+		index = generation->SyncWriterQueue::addBatch(entries, count);
+	} while(index == IS_FULL && grow(generation, count + 1));
+	reclaimer.exit(epoch);
+	if(index >= 0 && generation != this) {
+		stats.incrementAddedCount(count);
+		signalReadiness();
+	}
+	return index;
+}
+
+/*
+ * The reader stays inside the epoch while it holds the slots it claims, so the generation holding them is not deleted until they are released.
+ */
+unsigned int SyncQueue::removeOnline(ReaderIndex &readerIndex, QueueEntryBase *entries[], unsigned int maxCount) {
+	releaseOnline(readerIndex);
+	unsigned int epoch = reclaimer.enter();
+	SyncQueue *generation = getReadGeneration();
+	unsigned int count = generation->claimReadSlots(readerIndex, maxCount);
+	if(count == 0) {
+		reclaimer.exit(epoch);
+		return 0;
+	}
+	readerIndex.generation = generation;
+	readerIndex.epoch = epoch;
+	for(unsigned int i = 0; i < count; i++) {
+		entries[i] = generation->queueData[readerIndex.index + i];
+	}
+	return count;
+}
+
+void SyncQueue::releaseOnline(ReaderIndex &readerIndex) {
+	if(!readerIndex.isDone) {
+		return;
+	}
+	readerIndex.generation->releaseSlots(readerIndex);
+	readerIndex.generation = NULL;
+	reclaimer.exit(readerIndex.epoch);
+	if(retiredCount.load(std::memory_order_relaxed) && generationMutex.tryAcquire()) {
+		reclaimGenerations();
+		generationMutex.release();
+	}
+}
+
+bool SyncQueue::grow(SyncQueue *generation, unsigned int minimumSize) {
+	if(writeGeneration.load(std::memory_order_acquire) != generation) {
+		return true;
+	}
+	unsigned int newSize;
+	bool isSegment = false;
+	if(segmentSize) {
+		newSize = getInitialSize(std::max(segmentSize, minimumSize), powerOfTwoSize);
+		if(getGenerationsSize() + newSize > getMaxQueueSize()) {
+			return false;
+		}
+		isSegment = (newSize == getInitialSize(segmentSize, powerOfTwoSize));
+	} else {
+		newSize = generation->getNewQueueSize(minimumSize);
+		if(newSize <= generation->currentSize) {
+			/* the generation is at the max size */
+			return false;
+		}
+	}
+	/*
+	 * Once sealed, no more slots of the generation can be claimed, and the slots already claimed have been written,
+	 * so writers no longer use the data entries of the generation and the next generation can replace them in dataEntries.
+	 * Readers continue to use them through the generation's queueData.
+	 *
+	 * Only the writer that seals the generation replaces it.  It waits for the claimed slots to be written before acquiring
+	 * generationMutex, so that readers retiring generations, which acquire the mutex too, are not held up by the wait.
+	 */
+	int index = generation->seal();
+	if(index == IS_FULL) {
+		/* another writer sealed the generation */
+		while(writeGeneration.load(std::memory_order_acquire) == generation) {
+			sched_yield();
+		}
+		return true;
+	}
+	generationMutex.acquire();
+	SyncQueue *next = isSegment ? takeFreeSegment() : NULL;
+	if(next) {
+		generation->generationEntries = dataEntries->restoreEntries(next->currentSize, next->generationEntries);
+		next->generationEntries = NULL;
+	} else {
+		QueueOptions options;
+		options.lockFreeReaders = options.lockFreeWriters = true;
+		options.powerOfTwoSize = powerOfTwoSize;
+		next = new SyncQueue(newSize, dataEntries, stdoutLock, true, options);
+		generation->generationEntries = next->previousDataEntries;
+	}
+	generation->sealedIndex = index;
+	generation->nextGeneration.store(next, std::memory_order_release);
+	writeGeneration.store(next, std::memory_order_release);
+	stats.setSize(segmentSize ? getGenerationsSize() : next->currentSize);
+	reclaimGenerations();
+	generationMutex.release();
+	return true;
+}
+
+unsigned int SyncQueue::getGenerationsSize() {
+	unsigned int size = 0;
+	SyncQueue *generation = readGeneration.load(std::memory_order_acquire);
+	do {
+		size += generation->currentSize;
+		generation = generation->nextGeneration.load(std::memory_order_acquire);
+	} while(generation);
+	return size;
+}
+
+SyncQueue *SyncQueue::takeFreeSegment() {
+	if(freeSegments.empty()) {
+		return NULL;
+	}
+	SyncQueue *segment = freeSegments.back();
+	freeSegments.pop_back();
+	segment->resetSegment();
+	return segment;
+}
+
+/*
+ * A segment is only reused once no thread can be using it, and every slot was released by its reader before then,
+ * so the released slot markers have all been cleared.  Its data entries are kept, to be restored into dataEntries when it is reused.
+ */
+void SyncQueue::resetSegment() {
+	readIndex.store(0, std::memory_order_relaxed);
+	cachedWriteIndex = 0;
+	pendingReadCount = 0;
+	writeIndex.store(0, std::memory_order_relaxed);
+	cachedReadIndex = 0;
+	claimIndex.store(0, std::memory_order_relaxed);
+	claimTicket.store(0, std::memory_order_relaxed);
+	ticketBase = 0;
+	ticketSlot = 0;
+	nextGeneration.store(NULL, std::memory_order_relaxed);
+	sealedIndex = 0;
+}
+
+SyncQueue *SyncQueue::getReadGeneration() {
+	SyncQueue *generation = readGeneration.load(std::memory_order_acquire);
+	while(true) {
+		SyncQueue *next = generation->nextGeneration.load(std::memory_order_acquire);
+		if(!next || generation->getTicketSlot(generation->claimTicket.load(std::memory_order_relaxed)) != generation->sealedIndex) {
+			return generation;
+		}
+		/* every slot of the sealed generation has been claimed, so no reader needs to read from it again */
+		if(readGeneration.compare_exchange_strong(generation, next)) {
+			retire(generation);
+			generation = next;
+		}
+	}
+}
+
+void SyncQueue::retire(SyncQueue *generation) {
+	generationMutex.acquire();
+	retiredGenerations.push_back(std::make_pair(generation, reclaimer.getEpoch()));
+	retiredCount.store(retiredGenerations.size(), std::memory_order_relaxed);
+	reclaimGenerations();
+	generationMutex.release();
+}
+
+void SyncQueue::reclaimGenerations() {
+	reclaimer.tryAdvance();
+	std::vector<std::pair<SyncQueue *, unsigned int> >::iterator it = retiredGenerations.begin();
+	while(it != retiredGenerations.end()) {
+		if(reclaimer.isReclaimable(it->second)) {
+			SyncQueue *generation = it->first;
+			if(segmentSize && generation != this && freeSegments.size() < MAX_FREE_SEGMENTS
+					&& generation->currentSize == getInitialSize(segmentSize, powerOfTwoSize)) {
+				freeSegments.push_back(generation);
+			} else {
+				deleteGeneration(generation);
+			}
+			it = retiredGenerations.erase(it);
+		} else {
+			it++;
+		}
+	}
+	retiredCount.store(retiredGenerations.size(), std::memory_order_relaxed);
+}
+
+void SyncQueue::deleteGeneration(SyncQueue *generation) {
+	if(generation->generationEntries) {
+		dataEntries->deleteEntries(generation->generationEntries);
+		generation->generationEntries = NULL;
+	}
+	if(generation != this) {
+		delete generation;
+	}
 }
 
 void SyncQueue::setDebug(bool debug) {
@@ -8,6 +8,12 @@
 #ifndef SYNCQUEUE_H_
 #define SYNCQUEUE_H_
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/primitiveTypes.h"
+#include "EpochReclaimer.h"
 #include "SyncReaderList.h"
 #include "SyncWriterQueue.h"
 #include "ThreadInfo.h"
@@ -49,13 +55,196 @@ namespace hpqueue {
  *
  * In this queue, each reading thread maintains its own read index in addition to the read index stored in the queue.
  *
+ * With lock-free readers, the reader list is not used.  Instead, readers claim slots by advancing claimTicket
+ * with an atomic compare-and-swap.  The ticket counts the slots claimed since the last resize, so it never repeats,
+ * and the slot for a ticket is found by its distance from ticketBase.  When a reader has handled its entries it marks
+ * their slots in releasedSlots, and whichever reader holds advancingReadIndex moves the queue's read index past the
+ * released slots at the back of the queue, so that they can be written again:
+ * index: 0  1  2  3  4  5  6  7  8  9  10 11 12 13 14 15
+ *       [E  E  R  D  R  W  W  W  W  W  E  E  E  E  E  E ]
+ * D: slot released by its reader, which the read index cannot move past until the slot at index 2 is released
+ *
+ * With online resizing, this queue is the first of a chain of generations, each of them a SyncQueue with lock-free readers and writers.
+ * When the generation being written is full, a writer seals it so that no more slots can be claimed,
+ * and creates a generation twice the size for itself and the other writers to move on to.  Nothing is copied,
+ * and the readers continue reading the sealed generation until all its slots have been claimed, then move on to the next one.
+ * The sealed generation is deleted once the epoch has advanced far enough that no reader or writer can still be using it.
+ *
+ * With segments, the generations are all the same size, so the queue grows a segment at a time, and it is the total size of the segments
+ * that is limited by the max queue size.  Instead of being deleted, segments that can no longer be in use are reset and kept for reuse.
+ * A segment is a whole generation rather than a bare array of slots, so that segments reuse the generation code unchanged,
+ * at the cost of the indices, padding, released slot markers and stats of a SyncQueue for every segment,
+ * and of readers and writers moving between segments by way of the generation chain and the epoch reclaimer.
  */
 class SyncQueue: public SyncWriterQueue {
 
 	bool syncWriter;
 
+	bool lockFreeReaders;
+
+	char ticketPadding[CACHE_LINE_SIZE];
+
+	/*
+	 * With lock-free readers, the number of slots claimed by readers, counted from ticketBase
+	 */
+	std::atomic<INT_64> claimTicket;
+
+	char advancingPadding[CACHE_LINE_SIZE];
+
+	/*
+	 * With lock-free readers, set by the reader that is advancing the queue's read index
+	 */
+	std::atomic<bool> advancingReadIndex;
+
+	char advancingEndPadding[CACHE_LINE_SIZE];
+
+	/*
+	 * With lock-free readers, marks the slots that have been released by their readers but are still below the read index
+	 */
+	std::atomic<bool> *releasedSlots;
+
+	/*
+	 * With lock-free readers, the ticket of the slot at ticketSlot, both of which are reset when the queue is resized
+	 */
+	INT_64 ticketBase;
+	int ticketSlot;
+
+	/*
+	 * True with online resizing or with segments
+	 */
+	bool onlineResize;
+
+	/*
+	 * With segments, the size of each segment after the first, otherwise 0
+	 */
+	unsigned int segmentSize;
+
+	/*
+	 * With segments, the segments available for reuse, which are protected by generationMutex
+	 */
+	std::vector<SyncQueue *> freeSegments;
+
+	/*
+	 * The number of segments kept for reuse, enough for writers to move on to a segment while readers finish others
+	 */
+	static const unsigned int MAX_FREE_SEGMENTS = 4;
+
+	/*
+	 * With online resizing, the generation that replaced this one when this one was sealed, or NULL
+	 */
+	std::atomic<SyncQueue *> nextGeneration;
+
+	/*
+	 * With online resizing, the write index at which this generation was sealed, set before nextGeneration
+	 */
+	int sealedIndex;
+
+	/*
+	 * With online resizing, the data entries of this generation once the next generation has replaced them in dataEntries
+	 */
+	QueueData *generationEntries;
+
+	/*
+	 * With online resizing, the generations that writers add to and that readers remove from.
+	 * These may be the same generation, and either may be this queue.
+	 */
+	std::atomic<SyncQueue *> writeGeneration;
+	std::atomic<SyncQueue *> readGeneration;
+
+	/*
+	 * With online resizing, serializes creating generations and deleting them
+	 */
+	pthreadWrapper::Mutex generationMutex;
+
+	EpochReclaimer reclaimer;
+
+	/*
+	 * With online resizing, the generations no longer readable, each with the epoch in which it was retired
+	 */
+	std::vector<std::pair<SyncQueue *, unsigned int> > retiredGenerations;
+	std::atomic<unsigned int> retiredCount;
+
 	QueueEntryBase &removeSlot(ReaderIndex &readerIndex);
 
+	inline int getTicketSlot(INT_64 ticket) {
+		INT_64 slot = ticketSlot + (ticket - ticketBase);
+		return powerOfTwoSize ? (int) (slot & (currentSize - 1)) : (int) (slot % currentSize);
+	}
+
+	static std::atomic<bool> *createReleasedSlots(unsigned int size);
+
+	/*
+	 * Claims up to maxCount consecutive populated slots for a lock-free reader, returning the number claimed.
+	 */
+	unsigned int claimReadSlots(ReaderIndex &readerIndex, unsigned int maxCount);
+
+	/*
+	 * Moves the read index past the slots at the back of the queue that have been released.
+	 */
+	void advanceReadIndex();
+
+	void releaseSlots(ReaderIndex &readerIndex);
+
+	/*
+	 * Returns whether a lock-free reader would find a populated slot to claim.
+	 */
+	bool hasUnclaimedSlots();
+
+	static QueueOptions getGenerationOptions(const QueueOptions &options);
+
+	int addOnline(QueueEntryWriter &writer);
+
+	int reserveOnline(SlotSelector &selector, QueueReservation &reservation);
+
+	int addBatchOnline(QueueEntryBase *entries[], unsigned int count);
+
+	unsigned int removeOnline(ReaderIndex &readerIndex, QueueEntryBase *entries[], unsigned int maxCount);
+
+	void releaseOnline(ReaderIndex &readerIndex);
+
+	/*
+	 * Seals the given write generation and replaces it with a new generation with at least minimumSize slots,
+	 * returning false if the queue has reached its max size.
+	 * Returns true without doing anything if another writer has already replaced the given generation,
+	 * or once another writer that sealed the given generation has replaced it.
+	 */
+	bool grow(SyncQueue *generation, unsigned int minimumSize);
+
+	/*
+	 * Returns the total size of the generations still in use, the caller having entered an epoch.
+	 */
+	unsigned int getGenerationsSize();
+
+	/*
+	 * Returns a free segment for reuse, or NULL if there is none.  The caller must hold generationMutex.
+	 */
+	SyncQueue *takeFreeSegment();
+
+	/*
+	 * Empties a segment so that it can be reused.
+	 */
+	void resetSegment();
+
+	/*
+	 * Returns the generation to read from, moving readers on from any generations which are sealed and have had all their slots claimed.
+	 * The caller must have entered an epoch.
+	 */
+	SyncQueue *getReadGeneration();
+
+	void retire(SyncQueue *generation);
+
+	/*
+	 * Deletes the retired generations that can no longer be in use.  The caller must hold generationMutex.
+	 */
+	void reclaimGenerations();
+
+	void deleteGeneration(SyncQueue *generation);
+
+	/*
+	 * With the read list, the slots in use run up to the slots assigned to the front reader, which may not yet be populated.
+	 */
+	unsigned int getUsedSlots();
+
 public:
 	/**
 	 * This class maintains a linked list of indices, each one indicating an entry of the underlying queue currently being read.
@@ -69,22 +258,78 @@ public:
 			unsigned int queueSize,
 			ProcessingQueueDataArray *dataEntries,
 			pthreadWrapper::Mutex *stdoutLock,
-			bool syncWriter = true) :
-		SyncWriterQueue(queueSize, dataEntries, stdoutLock),
+			bool syncWriter = true,
+			const QueueOptions &options = QueueOptions()) :
+		SyncWriterQueue(queueSize, dataEntries, stdoutLock, false, getGenerationOptions(options)),
 		syncWriter(syncWriter),
+		lockFreeReaders(options.lockFreeReaders || options.onlineResize || options.segmentSize > 0),
+		claimTicket(0),
+		advancingReadIndex(false),
+		releasedSlots(lockFreeReaders ? createReleasedSlots(currentSize) : NULL),
+		ticketBase(0),
+		ticketSlot(0),
+		onlineResize(options.onlineResize || options.segmentSize > 0),
+		segmentSize(options.segmentSize),
+		nextGeneration(NULL),
+		sealedIndex(0),
+		generationEntries(NULL),
+		writeGeneration(this),
+		readGeneration(this),
+		retiredCount(0),
 		readList(*this, stdoutLock) {}
 
-	virtual ~SyncQueue() {}
+	virtual ~SyncQueue();
 
 	bool isEmpty(ReaderIndex &);
 
+	/*
+	 * Returns whether the reader would find an entry to remove, like isEmpty but changing neither the reader index nor the queue,
+	 * so that a thread other than the reader may check on the reader's behalf, such as to decide whether to wake it.
+	 */
+	bool hasWorkFor(const ReaderIndex &readerIndex);
+
 	QueueEntryBase &remove(ReaderIndex &readerIndex);
 
-	int add(QueueEntryBase &entry);
+	/*
+	 * Assigns the reader a span of up to maxCount consecutive populated slots with a single pass through the read list,
+	 * storing the entries in entries and returning their number.
+	 * When nothing is populated beyond the front of the read list, the reader is assigned a single slot as with remove.
+	 */
+	unsigned int removeBatch(ReaderIndex &readerIndex, QueueEntryBase *entries[], unsigned int maxCount);
+
+	/*
+	 * With lock-free readers, releases the slots the reader last removed so that they can be written again.
+	 * Otherwise the slots are released when the reader returns for more entries.
+	 */
+	void release(ReaderIndex &readerIndex);
+
+	using SyncWriterQueue::add;
+
+	int add(QueueEntryWriter &writer);
+
+	/*
+	 * With online resizing, the slot is reserved in the current write generation, which cannot be retired until the reservation is committed or aborted.
+	 */
+	int reserve(SlotSelector &selector, QueueReservation &reservation);
+
+	void commit(QueueReservation &reservation);
+
+	void abort(QueueReservation &reservation);
+
+	int addBatch(QueueEntryBase *entries[], unsigned int count);
 
 	void resize(unsigned int newSize);
 
+	bool isResizable();
+
+	int getNumElements();
+
 	void startAccess(ReaderIndex &readerIndex) {
+		if(lockFreeReaders) {
+			readerIndex.isDone = false;
+			readerIndex.inQueue = true;
+			return;
+		}
 		if(debug) {
 			ThreadInfo threadInfo;
 			threadInfo.initAsCurrentThread();
@@ -105,6 +350,11 @@ public:
 	}
 
 	void endAccess(ReaderIndex &readerIndex) {
+		if(lockFreeReaders) {
+			release(readerIndex);
+			readerIndex.inQueue = false;
+			return;
+		}
 		if(debug) {
 			ThreadInfo threadInfo;
 			threadInfo.initAsCurrentThread();
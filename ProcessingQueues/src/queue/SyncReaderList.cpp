@@ -5,6 +5,7 @@
  *      Author: sfoley
  */
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "SyncReaderList.h"
@@ -27,14 +28,35 @@ void SyncReaderList::moveOut(ReaderIndex &index) {
 		 * ruin the queue's empty check (isEmpty when readIndex == writeIndex, isFull when readIndex == writeIndex + 1).
 		 * When the queue is empty, it would think it's full.  readIndex must stay at the same level or below writeIndex.
 		 */
-		queue.readIndex = back->index;
+		queue.readIndex.store(back->index, std::memory_order_release);
 	} else {
 		index.previous->next = index.next;
 	}
 	index.next->previous = index.previous;
 }
 
-bool SyncReaderList::moveToFront(ReaderIndex &index) {
+int SyncReaderList::getBatchCount(int index, unsigned int maxCount) {
+	if(maxCount <= 1) {
+		return 1;
+	}
+	/*
+	 * The populated slots run from the queue's read index up to the write index, and the slots assigned to readers
+	 * lie in the same range or just past it, so slots are compared relative to the read index.
+	 * The back of the list is at or above the queue's read index, so the populated slots past the front never reach it.
+	 */
+	int queueReadIndex = queue.readIndex.load(std::memory_order_relaxed);
+	int currentWriteIndex = queue.writeIndex.load(std::memory_order_acquire);
+	int populated = queue.adjustIndexForComparison(currentWriteIndex, queueReadIndex) - queue.adjustIndexForComparison(index, queueReadIndex);
+	if(populated <= 1) {
+		/* the reader will wait on the single slot until it is populated */
+		return 1;
+	}
+	/* a batch does not wrap around the end of the queue, so that its entries are consecutive */
+	int count = std::min(populated, (int) queue.currentSize - index);
+	return std::min(count, (int) maxCount);
+}
+
+bool SyncReaderList::moveToFront(ReaderIndex &index, unsigned int maxCount) {
 	if(!index.inQueue) {
 		throw std::logic_error("must be added to queue ReadList to use SyncReaderQueue");
 	}
@@ -50,7 +72,7 @@ bool SyncReaderList::moveToFront(ReaderIndex &index) {
 	}
 
 	/* try to move to the front so we can read another slot */
-	int nextIndex = queue.nextIndex(front->index);
+	int nextIndex = getFrontNextIndex();
 	if(nextIndex != back->index) {
 		/* we can move to the front without hitting the back */
 		index.index = nextIndex;
@@ -60,8 +82,9 @@ bool SyncReaderList::moveToFront(ReaderIndex &index) {
 			index.next = NULL;
 			front = front->next = &index;
 		} else if (&index == back) {
-			queue.readIndex = index.index;    //we are at front and back.
+			queue.readIndex.store(index.index, std::memory_order_release);    //we are at front and back.
 		}
+		index.count = getBatchCount(nextIndex, maxCount);
 	} else {
 		/*
 		 * The list spans the whole queue (unlikely to ever happen with larger queues)
@@ -91,8 +114,9 @@ bool SyncReaderList::moveToFront(ReaderIndex &index) {
 				front->previous = &index;
 
 				index.index = index.previous->index;
+				index.count = 1;
 			} /* else there is only two entries in the list */
-			queue.readIndex = back->index;
+			queue.readIndex.store(back->index, std::memory_order_release);
 
 			if(debug) {
 				ThreadInfo threadInfo;
@@ -152,6 +176,7 @@ void SyncReaderList::remove(ReaderIndex &index) {
 					back = front;
 				}
 				front->index = index.index;
+				front->count = index.count;
 			} else {
 				/* the front will replace us, and the second-to-front will become the new front */
 				ReaderIndex *newFront = front->previous;
@@ -168,6 +193,7 @@ void SyncReaderList::remove(ReaderIndex &index) {
 				front->next = index.next;
 				front->next->previous = front;
 				front->index = index.index;
+				front->count = index.count;
 				front = newFront;
 			}
 		} else {
@@ -182,7 +208,7 @@ void SyncReaderList::remove(ReaderIndex &index) {
 	} else if(&index == back) {
 		/* we are both front and back, so we are the only entry in the queue, and the entry is done */
 		if(index.isDone && !queue.isEmpty(index)) {
-			queue.readIndex = queue.nextIndex(index.index);
+			queue.readIndex.store(queue.advanceIndex(index.index, index.count), std::memory_order_release);
 		}
 		front = back = index.previous = index.next = NULL;
 	} else {
@@ -208,12 +234,13 @@ void SyncReaderList::add(ReaderIndex &index) {
 		throw std::logic_error("already added");
 	}
 	indexMutex.acquire();
+	index.count = 1;
 	if(front == NULL) {
 		index.index = queue.readIndex;
 		front = back = index.next = index.previous = &index;
 		index.isDone = false;
 	} else {
-		int nextIndex = queue.nextIndex(front->index);
+		int nextIndex = getFrontNextIndex();
 		if(nextIndex != back->index) {
 			index.next = NULL;
 			index.previous = front;
@@ -255,6 +282,18 @@ void SyncReaderList::adjust(int adjustment, int queueReadIndex) {
 	}
 }
 
+void SyncReaderList::rebase(int queueReadIndex, int oldSize) {
+	ReaderIndex *readerIndex = back;
+	while(readerIndex != NULL) {
+		int index = readerIndex->index;
+		readerIndex->index = (index >= queueReadIndex) ? (index - queueReadIndex) : (index + oldSize - queueReadIndex);
+		readerIndex = readerIndex->next;
+		if(readerIndex == back) {
+			break;
+		}
+	}
+}
+
 void SyncReaderList::setDebug(bool debug) {
 	this->debug = debug;
 }
@@ -25,7 +25,8 @@ namespace hpqueue {
  *
  * Because of the linked list, threads which wish to become readers must call add, and threads which no longer wish to be
  * readers must call remove.  When a thread has finished reading from a queue entry, it can be assigned a new queue entry
- * by calling moveToFront.
+ * by calling moveToFront.  A ReaderIndex may be assigned a batch of consecutive slots,
+ * in which case the next reader to move to the front is assigned the slots following the batch.
  */
 class SyncReaderList {
 	friend class SyncQueue;
@@ -38,16 +39,36 @@ class SyncReaderList {
 
 	void moveOut(ReaderIndex &index);
 
+	/*
+	 * Returns the number of consecutive slots, up to maxCount, that can be assigned to a reader starting at the given index.
+	 * When the slot at the index is populated, the slots assigned are those populated slots that follow it,
+	 * without reaching the back of the list or wrapping around the end of the queue.
+	 */
+	int getBatchCount(int index, unsigned int maxCount);
+
+	/*
+	 * Returns the index following the slots assigned to the front of the list.
+	 */
+	inline int getFrontNextIndex() {
+		return queue.advanceIndex(front->index, front->count);
+	}
+
 	bool debug;
 
 public:
 	SyncReaderList(ReaderWriterQueue &queue, pthreadWrapper::Mutex *stdoutLock) :  indexMutex(), queue(queue), front(NULL), back(NULL), stdoutLock(stdoutLock), debug(false) {}
 	virtual ~SyncReaderList() {}
-	bool moveToFront(ReaderIndex &index);
+	bool moveToFront(ReaderIndex &index, unsigned int maxCount = 1);
 	void remove(ReaderIndex &index);
 	void add(ReaderIndex &index);
 	friend std::ostream& operator <<(std::ostream &outputStream, SyncReaderList &readerList);
 	void adjust(int adjustment, int queueReadIndex);
+
+	/*
+	 * After the queue shrinks, moving the slot at queueReadIndex to the start of the queue,
+	 * moves each reader to the same distance from the start of the queue.
+	 */
+	void rebase(int queueReadIndex, int oldSize);
 	void setDebug(bool debug);
 };
 
@@ -5,15 +5,164 @@
  *      Author: sfoley
  */
 
+#include <sched.h>
+
 #include "SyncWriterQueue.h"
 
 namespace hpqueue {
 
-int SyncWriterQueue::add(QueueEntryBase &entry) {
+int SyncWriterQueue::add(QueueEntryWriter &writer) {
+	if(lockFreeWriters) {
+		return addLockFree(writer);
+	}
+	addMutex.acquire();
+	int index = ReaderWriterQueue::add(writer);
+	addMutex.release();
+	return index;
+}
+
+int SyncWriterQueue::addBatch(QueueEntryBase *entries[], unsigned int count) {
+	if(lockFreeWriters) {
+		return addBatchLockFree(entries, count);
+	}
 	addMutex.acquire();
-	int index = ReaderWriterQueue::add(entry);
+	int index = ReaderWriterQueue::addBatch(entries, count);
 	addMutex.release();
 	return index;
 }
 
+int SyncWriterQueue::claimSlots(unsigned int count, int &next) {
+	int index = claimIndex.load(std::memory_order_relaxed);
+	do {
+		if(index == IS_FULL) {
+			/* the queue has been sealed */
+			return IS_FULL;
+		}
+		if(getFreeSlots(index, readIndex.load(std::memory_order_acquire)) < count) {
+			/* queue is full, cannot write */
+			return IS_FULL;
+		}
+		next = advanceIndex(index, count);
+	} while(!claimIndex.compare_exchange_weak(index, next, std::memory_order_relaxed));
+	return index;
+}
+
+void SyncWriterQueue::publishSlots(int index, int next) {
+	/*
+	 * The writers that claimed the slots before ours must publish first,
+	 * otherwise advancing writeIndex would expose their slots to readers before they are written.
+	 */
+	while(writeIndex.load(std::memory_order_acquire) != index) {
+		sched_yield();
+	}
+	writeIndex.store(next, std::memory_order_release);
+	signalReadiness();
+}
+
+int SyncWriterQueue::seal() {
+	int index = claimIndex.exchange(IS_FULL);
+	if(index == IS_FULL) {
+		return IS_FULL;
+	}
+	while(writeIndex.load(std::memory_order_acquire) != index) {
+		sched_yield();
+	}
+	return index;
+}
+
+int SyncWriterQueue::addLockFree(QueueEntryWriter &writer) {
+	if(!writer.getSelector().isCompatible(*dataEntries)) {
+		return CANNOT_ADD;
+	}
+	int next;
+	int index = claimSlots(1, next);
+	if(index == IS_FULL) {
+		return IS_FULL;
+	}
+	bool inserted = insert(writer, index);
+	if(!inserted) {
+		/* the slot is claimed, so it must be published, but readers will skip it */
+		queueData[index] = &QueueEntryBase::nullEntry;
+	}
+	publishSlots(index, next);
+	if(!inserted) {
+		return CANNOT_ADD;
+	}
+	stats.incrementAddedCount(1);
+	return index;
+}
+
+int SyncWriterQueue::addBatchLockFree(QueueEntryBase *entries[], unsigned int count) {
+	if(!isCompatibleBatch(entries, count)) {
+		return CANNOT_ADD;
+	}
+	int next;
+	int index = claimSlots(count, next);
+	if(index == IS_FULL) {
+		return IS_FULL;
+	}
+	unsigned int inserted = insertBatch(entries, count, index);
+	publishSlots(index, next);
+	stats.incrementAddedCount(inserted);
+	return index;
+}
+
+void SyncWriterQueue::resize(unsigned int size) {
+	ReaderWriterQueue::resize(size);
+	if(lockFreeWriters) {
+		/* no slots are claimed during a resize, but a shrink moves the write index */
+		claimIndex.store(writeIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+int SyncWriterQueue::reserve(SlotSelector &selector, QueueReservation &reservation) {
+	if(!lockFreeWriters) {
+		addMutex.acquire();
+		int index = ReaderWriterQueue::reserve(selector, reservation);
+		if(index < 0) {
+			addMutex.release();
+		}
+		return index;
+	}
+	if(!selector.isCompatible(*dataEntries)) {
+		return CANNOT_ADD;
+	}
+	int next;
+	int index = claimSlots(1, next);
+	if(index == IS_FULL) {
+		return IS_FULL;
+	}
+	QueueEntryBase *queueEntry = selector.select(*dataEntries, index);
+	if(!queueEntry) {
+		queueData[index] = &QueueEntryBase::nullEntry;
+		publishSlots(index, next);
+		return CANNOT_ADD;
+	}
+	queueData[index] = queueEntry;
+	reservation.entry = queueEntry;
+	reservation.index = index;
+	reservation.nextIndex = next;
+	reservation.queue = this;
+	return index;
+}
+
+void SyncWriterQueue::commit(QueueReservation &reservation) {
+	if(!lockFreeWriters) {
+		ReaderWriterQueue::commit(reservation);
+		addMutex.release();
+		return;
+	}
+	publishSlots(reservation.index, reservation.nextIndex);
+	stats.incrementAddedCount(1);
+}
+
+void SyncWriterQueue::abort(QueueReservation &reservation) {
+	if(!lockFreeWriters) {
+		addMutex.release();
+		return;
+	}
+	queueData[reservation.index] = &QueueEntryBase::nullEntry;
+	publishSlots(reservation.index, reservation.nextIndex);
+}
+
 }
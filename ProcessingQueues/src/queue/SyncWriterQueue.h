@@ -16,21 +16,85 @@ namespace hpqueue {
 /*
  * A single reader and multiple writer queue that has no locking between the reader and the writers.
  *
- * There exists locking between writers.
+ * There exists locking between writers, unless the queue was created with lock-free writers.
+ *
+ * With lock-free writers, each writer claims the slot at claimIndex with an atomic compare-and-swap,
+ * copies its entry into the slot, and then publishes the slot by advancing writeIndex.
+ * Slots are published in the order they were claimed, so writeIndex never moves past a slot that is still being written,
+ * and readers, which only look at writeIndex, never see a half-written slot:
+ *
+ * index: 0  1  2  3  4  5  6  7  8  9  10 11 12 13 14 15
+ *       [E  E  R  W  W  W  C  C  C  E  E  E  E  E  E  E ]
+ * C: slots claimed by writers that are still being written
+ *
+ * Here writeIndex is 6 and claimIndex is 9.
  */
 class SyncWriterQueue: public ReaderWriterQueue {
 protected:
 	pthreadWrapper::Mutex addMutex;
+
+	bool lockFreeWriters;
+
+	char claimPadding[CACHE_LINE_SIZE];
+
+	/*
+	 * With lock-free writers, indicates the next index to be claimed by a writer.
+	 * Otherwise it is unused.
+	 */
+	std::atomic<int> claimIndex;
+
+	char claimEndPadding[CACHE_LINE_SIZE];
+
+	/*
+	 * Claims the next count slots for writing, returning the index of the first, or IS_FULL.
+	 * On success, nextIndex is the index following the claimed slots.
+	 */
+	int claimSlots(unsigned int count, int &nextIndex);
+
+	/*
+	 * Makes the claimed slots from index up to nextIndex visible to readers,
+	 * waiting for slots claimed previously by other writers to be published first.
+	 */
+	void publishSlots(int index, int nextIndex);
+
+	int addLockFree(QueueEntryWriter &writer);
+
+	/*
+	 * With lock-free writers, stops any further slots being claimed, so that every add fails with IS_FULL,
+	 * and waits for the slots already claimed to be published.  Returns the write index at which writing stopped,
+	 * or IS_FULL at once if the queue was already sealed.
+	 */
+	int seal();
+
+	int addBatchLockFree(QueueEntryBase *entries[], unsigned int count);
+
 public:
 	SyncWriterQueue(
 			unsigned int queueSize,
 			ProcessingQueueDataArray *dataEntries,
 			pthreadWrapper::Mutex *stdoutLock,
-			bool deleteQueueData = false) :
-		ReaderWriterQueue(queueSize, dataEntries, stdoutLock, deleteQueueData) {}
+			bool deleteQueueData = false,
+			const QueueOptions &options = QueueOptions()) :
+		ReaderWriterQueue(queueSize, dataEntries, stdoutLock, deleteQueueData, options),
+		lockFreeWriters(options.lockFreeWriters),
+		claimIndex(0) {}
 
 	virtual ~SyncWriterQueue() {}
-	virtual int add(QueueEntryBase &entry);
+	using ReaderWriterQueue::add;
+	virtual int add(QueueEntryWriter &writer);
+	virtual int addBatch(QueueEntryBase *entries[], unsigned int count);
+	virtual void resize(unsigned int newSize);
+
+	/*
+	 * With lock-free writers the slot is claimed, otherwise the lock amongst writers is held until the reservation is committed or aborted.
+	 */
+	virtual int reserve(SlotSelector &selector, QueueReservation &reservation);
+	virtual void commit(QueueReservation &reservation);
+
+	/*
+	 * With lock-free writers, a claimed slot cannot be handed back, so it is published holding the null entry, which readers skip.
+	 */
+	virtual void abort(QueueReservation &reservation);
 };
 
 }
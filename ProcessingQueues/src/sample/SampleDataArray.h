@@ -3,58 +3,21 @@
 
 #include "SampleQueueEntry1.h"
 #include "SampleQueueEntry2.h"
-#include "queue/ProcessingQueueDataArray.h"
+#include "queue/MultiTypeDataArray.h"
 
 using namespace std;
 
 namespace hpqueue {
 
-class SampleDataArray : public ProcessingQueueDataArray {
-	struct SampleQueueData : public QueueData {
-		SampleQueueEntry1 data1; /* will hold both LiveSessionEntry and SessionEntry */
-		SampleQueueEntry2 data2;
-
-		QueueEntryBase *getQueueEntry(QueueEntryBase &entry) {
-			QueueEntryBase *queueEntry;
-			if(dynamic_cast<SampleQueueEntry1 *>(&entry)) {
-				queueEntry = &data1;
-			} else if(dynamic_cast<SampleQueueEntry2 *>(&entry)) {
-				queueEntry = &data2;
-			} else {
-				queueEntry = NULL;
-			}
-			return queueEntry;
-		}
-	};
-
-	bool isCompatibleEntry(QueueEntryBase &entry) {
-		return true;
-	}
-
-	QueueData &getEntry(unsigned int index) {
-		SampleQueueData *entries = static_cast<SampleQueueData *>(queueDataEntries);
-		return entries[index];
-	}
-
-	QueueData *resize(unsigned int queueSize) {
-		return ProcessingQueueDataArray::resize(queueSize, new SampleQueueData[queueSize]);
-	}
-
-	void deleteEntries(QueueData *entries) {
-		SampleQueueData *dataEntries = static_cast<SampleQueueData *>(entries);
-		delete [] dataEntries;
-	}
-
-	unsigned int getEntrySize() {
-		return sizeof(SampleQueueData);
-	}
-
+/*
+ * Each queue slot holds either a SampleQueueEntry1 or a SampleQueueEntry2, constructed when the slot is written.
+ */
+class SampleDataArray : public MultiTypeDataArray<SampleQueueEntry1, SampleQueueEntry2> {
 public:
-	SampleDataArray() {}
+	SampleDataArray(unsigned int payloadArenaSize = 0, const SlotStoragePolicy &storagePolicy = SlotStoragePolicy()) :
+		MultiTypeDataArray<SampleQueueEntry1, SampleQueueEntry2>(payloadArenaSize, storagePolicy) {}
 
-	virtual ~SampleDataArray() {
-		deleteEntries(queueDataEntries);
-	}
+	virtual ~SampleDataArray() {}
 };
 
 }
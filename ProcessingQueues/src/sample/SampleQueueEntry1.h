@@ -8,7 +8,10 @@
 #ifndef SENTENCEENTRY_H_
 #define SENTENCEENTRY_H_
 
+#include <utility>
+
 #include "SampleStatus.h"
+#include "queue/ArenaBuffer.h"
 #include "queue/QueueEntryBase.h"
 #include "base/DateTime.h"
 #include "queue/ResultReceiverHolder.h"
@@ -23,7 +26,7 @@ struct QueueEntryData1 {
 	ResultReceiverHolder<Status> statusHolder;
 
 	UINT_64 id1;
-	std::string string1;
+	ArenaString string1;
 	INT_32 id2;
 
 	bool withTimeStamp;
@@ -80,27 +83,52 @@ public:
 						string1,
 						id2,
 						timeStamp,
-						linkedStatus) {}
+						linkedStatus),
+				QueueEntryBase(getTypeTag<SampleQueueEntry1>()) {}
 
-	SampleQueueEntry1() {}
+	SampleQueueEntry1() : QueueEntryBase(getTypeTag<SampleQueueEntry1>()) {}
 
 	virtual ~SampleQueueEntry1() {}
 
+	/*
+	 * Populates the entry in place, such as the entry in a reserved queue slot, reusing the memory already held by the entry.
+	 */
+	void set(UINT_64 id1, const std::string &string1, INT_32 id2, const DateTime &timeStamp) {
+		this->id1 = id1;
+		this->string1.assign(string1);
+		this->id2 = id2;
+		this->withTimeStamp = timeStamp.hasTime();
+		this->timeStamp = timeStamp;
+	}
+
+	void setPayloadArena(PayloadArena *arena) {
+		string1.setArena(arena);
+	}
+
 	bool isNull() const {
 		return false;
 	}
 
 	QueueEntryBase& operator=(const QueueEntryBase& that){
-		const SampleQueueEntry1 *ptr = dynamic_cast<const SampleQueueEntry1 *>(&that);
+		const SampleQueueEntry1 *ptr = cast<SampleQueueEntry1>(that);
 		if(ptr) {
 			return SampleQueueEntry1::operator=(*ptr);
 		}
 		return QueueEntryBase::operator=(that);
 	}
 
+	QueueEntryBase& moveFrom(QueueEntryBase& that) {
+		SampleQueueEntry1 *ptr = cast<SampleQueueEntry1>(that);
+		if(ptr) {
+			QueueEntryData1::operator=(std::move(static_cast<QueueEntryData1 &>(*ptr)));
+			return *this;
+		}
+		return QueueEntryBase::moveFrom(that);
+	}
+
 	std::string &appendDataTo(std::string &str) const {
 		str.append("\tidentifier 1: ").append(getStringValue(id1)).
-			append("\n\tstring 1: ").append(string1).
+			append("\n\tstring 1: ").append(string1.c_str(), string1.size()).
 			append("\n\tidentifier 2: ").append(getStringValue(id2));
 		if(withTimeStamp) {
 			str.append("\n\ttime stamp: ").append(timeStamp);
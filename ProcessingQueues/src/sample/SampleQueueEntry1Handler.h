@@ -0,0 +1,33 @@
+/*
+ * SampleQueueEntry1Handler.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SAMPLE_SAMPLEQUEUEENTRY1HANDLER_H_
+#define SAMPLE_SAMPLEQUEUEENTRY1HANDLER_H_
+
+#include "SampleQueueEntry1.h"
+
+namespace hpqueue {
+
+/**
+ * Handles the entries of a TypedQueueProcessor holding only SampleQueueEntry1 entries.
+ *
+ * Each worker has its own copy of the handler, so no need for thread-safety.
+ */
+struct SampleQueueEntry1Handler {
+	UINT_32 count;
+
+	SampleQueueEntry1Handler(): count(0) {}
+
+	void operator()(SampleQueueEntry1 &entry) {
+		QueueEntryData1 &data = Access<SampleQueueEntry1, QueueEntryData1>(entry);
+		data.setStatus(Status(Status::STATUS_SUCCESS));
+		count++;
+	}
+};
+
+}
+
+#endif /* SAMPLE_SAMPLEQUEUEENTRY1HANDLER_H_ */
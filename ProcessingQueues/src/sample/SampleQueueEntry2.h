@@ -8,7 +8,11 @@
 #ifndef ACCESSENTRY_H_
 #define ACCESSENTRY_H_
 
+#include <stdexcept>
+#include <utility>
+
 #include "base/DateTime.h"
+#include "base/InlineBuffer.h"
 #include "sample/SampleStatus.h"
 #include "queue/QueueEntryBase.h"
 #include "queue/ResultReceiverHolder.h"
@@ -19,15 +23,24 @@ namespace hpqueue {
  * Holds data members for SampleQueueEntry2 to restrict access to them.
  */
 struct QueueEntryData2 {
+	/*
+	 * The most characters and bytes held by str and bytes, which are held inline and so cannot grow.
+	 */
+	static const unsigned int STR_CAPACITY = 32;
+	static const unsigned int BYTES_CAPACITY = 32;
+
 	bool withTimeStamp;
 	DateTime timeStamp;
 	std::string stringData;
-	std::string str;
-	std::vector<INT_8> bytes;
+	InlineString<STR_CAPACITY> str;
+	InlineBytes<BYTES_CAPACITY> bytes;
 
 	//Data to be returned to producer by the consumer
 	ResultReceiverHolder<Status> statusValue;
 
+	/*
+	 * Throws std::length_error if str or bytes do not fit, rather than silently truncating them.
+	 */
 	QueueEntryData2(
 			const std::string &stringData,
 			bool withTimeStamp,
@@ -38,9 +51,14 @@ struct QueueEntryData2 {
 		withTimeStamp(withTimeStamp),
 		timeStamp(timeStamp),
 		stringData(stringData),
-		str(str),
-		bytes(bytes),
-		statusValue(linkedStatus) {}
+		statusValue(linkedStatus) {
+		if(!this->str.assign(str)) {
+			throw std::length_error("str longer than QueueEntryData2::STR_CAPACITY");
+		}
+		if(!this->bytes.assign(bytes)) {
+			throw std::length_error("bytes longer than QueueEntryData2::BYTES_CAPACITY");
+		}
+	}
 
 	QueueEntryData2():
 		withTimeStamp(false),
@@ -80,20 +98,30 @@ public:
 				timeStamp,
 				strOrCharOrNull,
 				vectorOrArray,
-				linkedStatus) {}
+				linkedStatus),
+		QueueEntryBase(getTypeTag<SampleQueueEntry2>()) {}
 
-	SampleQueueEntry2() {}
+	SampleQueueEntry2() : QueueEntryBase(getTypeTag<SampleQueueEntry2>()) {}
 
 	virtual ~SampleQueueEntry2() {}
 
 	QueueEntryBase& operator=(const QueueEntryBase& that) {
-		const SampleQueueEntry2 *ptr = dynamic_cast<const SampleQueueEntry2 *>(&that);
+		const SampleQueueEntry2 *ptr = cast<SampleQueueEntry2>(that);
 		if(ptr) {
 			return SampleQueueEntry2::operator=(*ptr);
 		}
 		return QueueEntryBase::operator=(that);
 	}
 
+	QueueEntryBase& moveFrom(QueueEntryBase& that) {
+		SampleQueueEntry2 *ptr = cast<SampleQueueEntry2>(that);
+		if(ptr) {
+			QueueEntryData2::operator=(std::move(static_cast<QueueEntryData2 &>(*ptr)));
+			return *this;
+		}
+		return QueueEntryBase::moveFrom(that);
+	}
+
 	bool isNull() const {
 		return false;
 	}
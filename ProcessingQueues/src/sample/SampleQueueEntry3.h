@@ -0,0 +1,101 @@
+/*
+ * SampleQueueEntry3.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SAMPLE_SAMPLEQUEUEENTRY3_H_
+#define SAMPLE_SAMPLEQUEUEENTRY3_H_
+
+#include "base/InlineBuffer.h"
+#include "queue/PlainDataEntry.h"
+#include "queue/QueueEntryBase.h"
+
+namespace hpqueue {
+
+/**
+ * Holds data members for SampleQueueEntry3 to restrict access to them.
+ *
+ * The fields are all plain data, so that entries are copied into their slots with memcpy, see PlainDataEntry.
+ */
+struct QueueEntryData3 {
+	UINT_64 sequence;
+	INT_32 price;
+	INT_32 quantity;
+	InlineString<15> symbol;
+
+	QueueEntryData3(
+		UINT_64 sequence,
+		INT_32 price,
+		INT_32 quantity,
+		const std::string &symbol):
+			sequence(sequence),
+			price(price),
+			quantity(quantity),
+			symbol(symbol) {}
+
+	QueueEntryData3():
+		sequence(0),
+		price(0),
+		quantity(0),
+		symbol() {}
+};
+
+/**
+ * A sample data class holding only plain data.
+ *
+ * As with SampleQueueEntry1, the data fields are located in the parent class QueueEntryData3 to restrict access.
+ */
+class SampleQueueEntry3: private QueueEntryData3, public QueueEntryBase {
+	friend class Access<SampleQueueEntry3, QueueEntryData3>;
+	friend class Access<const SampleQueueEntry3, const QueueEntryData3>;
+
+public:
+	typedef QueueEntryData3 PlainData;
+
+	SampleQueueEntry3(
+			UINT_64 sequence,
+			INT_32 price,
+			INT_32 quantity,
+			const std::string &symbol) :
+				QueueEntryData3(
+						sequence,
+						price,
+						quantity,
+						symbol),
+				QueueEntryBase(getTypeTag<SampleQueueEntry3>()) {}
+
+	SampleQueueEntry3() : QueueEntryBase(getTypeTag<SampleQueueEntry3>()) {}
+
+	virtual ~SampleQueueEntry3() {}
+
+	bool isNull() const {
+		return false;
+	}
+
+	QueueEntryBase& operator=(const QueueEntryBase& that){
+		const SampleQueueEntry3 *ptr = cast<SampleQueueEntry3>(that);
+		if(ptr) {
+			return SampleQueueEntry3::operator=(*ptr);
+		}
+		return QueueEntryBase::operator=(that);
+	}
+
+	std::string &appendDataTo(std::string &str) const {
+		str.append("\tsequence: ").append(getStringValue(sequence)).
+			append("\n\tsymbol: ").append(symbol.c_str(), symbol.size()).
+			append("\n\tprice: ").append(getStringValue(price)).
+			append("\n\tquantity: ").append(getStringValue(quantity));
+		return str;
+	}
+
+	std::string &appendTo(std::string &str) const {
+		str.append("Plain Entry:\n");
+		appendDataTo(str);
+		return str;
+	}
+};
+
+}
+
+#endif /* SAMPLE_SAMPLEQUEUEENTRY3_H_ */
@@ -0,0 +1,37 @@
+/*
+ * SampleQueueEntry3Handler.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef SAMPLE_SAMPLEQUEUEENTRY3HANDLER_H_
+#define SAMPLE_SAMPLEQUEUEENTRY3HANDLER_H_
+
+#include "SampleQueueEntry3.h"
+
+namespace hpqueue {
+
+/**
+ * Handles the entries of a TypedQueueProcessor holding only SampleQueueEntry3 entries,
+ * counting those whose fields did not survive being copied and relocated with memcpy.
+ *
+ * Each worker has its own copy of the handler, so no need for thread-safety.
+ */
+struct SampleQueueEntry3Handler {
+	UINT_32 count;
+	UINT_32 corrupted;
+
+	SampleQueueEntry3Handler(): count(0), corrupted(0) {}
+
+	void operator()(SampleQueueEntry3 &entry) {
+		QueueEntryData3 &data = Access<SampleQueueEntry3, QueueEntryData3>(entry);
+		if(data.price != static_cast<INT_32>(data.sequence * 2) || data.symbol.str() != "PLAIN") {
+			corrupted++;
+		}
+		count++;
+	}
+};
+
+}
+
+#endif /* SAMPLE_SAMPLEQUEUEENTRY3HANDLER_H_ */
@@ -12,6 +12,7 @@
 #include "SampleQueueEntry1.h"
 #include "SampleQueueEntry2.h"
 #include "consumer/Consumer.h"
+#include "queue/QueueEntryTypes.h"
 
 namespace hpqueue {
 
@@ -20,17 +21,7 @@ class SampleQueueEntryConsumer: public Consumer {
 	/* we are using one of these consumers per worker, so no need for thread-safety */
 
 	void handle(QueueEntryBase &entry) {
-		SampleQueueEntry1 *sampleQueueEntry1;
-		SampleQueueEntry2 *sampleQueueEntry2;
-		if((sampleQueueEntry1 = dynamic_cast<SampleQueueEntry1 *>(&entry))) {
-			QueueEntryData1 &data = Access<SampleQueueEntry1, QueueEntryData1>(*sampleQueueEntry1);
-			data.setStatus(Status(Status::STATUS_SUCCESS));
-			count++;
-		} else if((sampleQueueEntry2 = dynamic_cast<SampleQueueEntry2 *>(&entry))) {
-			QueueEntryData2 &data = Access<SampleQueueEntry2, QueueEntryData2>(*sampleQueueEntry2);
-			data.setStatus(Status(Status::STATUS_SUCCESS));
-			count++;
-		}
+		QueueEntryTypes<SampleQueueEntry1, SampleQueueEntry2>::visit(entry, *this);
 	}
 
 public:
@@ -38,6 +29,20 @@ public:
 
 	SampleQueueEntryConsumer(): count(0) {}
 
+	/* each entry is handed to one of these by handle, according to its type */
+
+	void operator()(SampleQueueEntry1 &entry) {
+		QueueEntryData1 &data = Access<SampleQueueEntry1, QueueEntryData1>(entry);
+		data.setStatus(Status(Status::STATUS_SUCCESS));
+		count++;
+	}
+
+	void operator()(SampleQueueEntry2 &entry) {
+		QueueEntryData2 &data = Access<SampleQueueEntry2, QueueEntryData2>(entry);
+		data.setStatus(Status(Status::STATUS_SUCCESS));
+		count++;
+	}
+
 	~SampleQueueEntryConsumer() {}
 };
 
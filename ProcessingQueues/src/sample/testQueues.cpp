@@ -6,10 +6,15 @@
 #include <vector>
 #include <sstream>
 #include <iterator>
+#include <utility>
+#include <poll.h>
 
 #include "consumer/QueueProducerInterface.h"
+#include "consumer/TypedQueueProcessor.h"
 #include "queue/ResultReceiver.h"
 #include "SampleQueueEntryConsumer.h"
+#include "SampleQueueEntry1Handler.h"
+#include "SampleQueueEntry3Handler.h"
 
 using namespace std;
 using namespace hpqueue;
@@ -45,12 +50,22 @@ void testPopulate(QueueProducerInterface &operationsProcessor) {
 		time_t currentTime = time(NULL);
 		stringstream stream;
 		stream << "thread " << threadInfo.getThreadId() << " " << i << " total " << getNext() << " " << currentTime;
-		SampleQueueEntry1 data(
-				i,
-				stream.str(),
-				4,
-				DateTime(34567));
-		operationsProcessor.add(data);
+		if(i % 2) {
+			//construct the entry in the queue itself
+			operationsProcessor.emplace<SampleQueueEntry1>(
+					i,
+					stream.str(),
+					4,
+					DateTime(34567));
+		} else {
+			//populate the entry in its queue slot
+			QueueReservation reservation;
+			SampleQueueEntry1 *data = operationsProcessor.reserve<SampleQueueEntry1>(reservation);
+			if(data) {
+				data->set(i, stream.str(), 4, DateTime(34567));
+				operationsProcessor.commit(reservation);
+			}
+		}
 	}
 
 	operationsProcessor.writeQueueStats(cout);
@@ -69,7 +84,6 @@ void testPopulate(QueueProducerInterface &operationsProcessor) {
 				stream.str(),
 				5,
 				DateTime(676868));
-		operationsProcessor.add(data);
 
 		SampleQueueEntry2 data2(
 				stream.str(),
@@ -77,7 +91,10 @@ void testPopulate(QueueProducerInterface &operationsProcessor) {
 				DateTime(11),
 				"xy",
 				"yz");
-		operationsProcessor.add(data2);
+
+		//add the two as a batch
+		QueueEntryBase *batch[] = {&data, &data2};
+		operationsProcessor.addBatch(batch, 2);
 
 	}
 
@@ -96,7 +113,8 @@ void testPopulate(QueueProducerInterface &operationsProcessor) {
 				4,
 				DateTime(34567),
 				statusHolderPtr);
-		operationsProcessor.add(data);
+		//the entry is not needed afterwards, so its data can be moved into the queue
+		operationsProcessor.add(std::move(data));
 		Status status = statusHolder1.getValue();
 		//cout << "result was " << status << endl;
 	}
@@ -140,6 +158,153 @@ int max(int a, int b) {
 	return (a > b) ? a : b;
 }
 
+void testTypedQueue() {
+	int numWorkerThreads = 4;
+	QueueOptions options;
+	options.lockFreeWriters = true;
+	options.maxRemoveBatchSize = 16;
+	TypedQueueProcessor<SampleQueueEntry1, SampleQueueEntry1Handler> typedProcessor(numWorkerThreads, 3 /* queue size */, SampleQueueEntry1Handler(), options);
+	pthreadWrapper::ThreadConfig threadConfig;
+	threadConfig.stackSize = 256 * 1024;
+	typedProcessor.setThreadConfig(threadConfig);
+	typedProcessor.start();
+	UINT_32 totalExpected = 0;
+	for(int i = 1; i <= count2; i++, totalExpected += 3) {
+		SampleQueueEntry1 data(i, "typed", 5, DateTime(676868));
+		typedProcessor.add(data);
+		typedProcessor.emplace(i, "typed emplaced", 6, DateTime(676868));
+		QueueReservation reservation;
+		SampleQueueEntry1 *reserved = typedProcessor.reserve(reservation);
+		if(reserved) {
+			reserved->set(i, "typed reserved", 7, DateTime(676868));
+			typedProcessor.commit(reservation);
+		}
+	}
+	cout << "counting the " << totalExpected << " typed entries consumed" << endl;
+	sleep(1);
+	for(int j = numWorkerThreads - 1; j >= 0; j--) {
+		UINT_32 *ptr = &typedProcessor.getHandler(j).count;
+		UINT_32 removed = __sync_lock_test_and_set(ptr, 0);
+		totalExpected -= removed;
+		cout << "typed handler " << (j + 1) << " handled " << removed << ", remaining down to " << totalExpected << endl;
+	}
+	if(totalExpected > 0) {
+		cout << "missed " << totalExpected << endl;
+	}
+	typedProcessor.writeQueueStats(cout);
+	typedProcessor.terminate();
+}
+
+/*
+ * Runs plain data entries, which are copied into their slots and relocated on resize with memcpy,
+ * through a typed processor whose queue starts small enough to be resized while it holds entries.
+ */
+void testPlainDataQueue() {
+	int numWorkerThreads = 4;
+	QueueOptions options;
+	options.lockFreeWriters = true;
+	TypedQueueProcessor<SampleQueueEntry3, SampleQueueEntry3Handler> plainProcessor(numWorkerThreads, 3 /* queue size */, SampleQueueEntry3Handler(), options);
+	plainProcessor.start();
+	UINT_32 totalExpected = 0;
+	for(int i = 1; i <= count2 * 3; i++, totalExpected++) {
+		SampleQueueEntry3 data(i, i * 2, 100, "PLAIN");
+		plainProcessor.add(data);
+	}
+	cout << "counting the " << totalExpected << " plain entries consumed" << endl;
+	sleep(1);
+	for(int j = numWorkerThreads - 1; j >= 0; j--) {
+		SampleQueueEntry3Handler &handler = plainProcessor.getHandler(j);
+		UINT_32 removed = __sync_lock_test_and_set(&handler.count, 0);
+		totalExpected -= removed;
+		cout << "plain handler " << (j + 1) << " handled " << removed << ", remaining down to " << totalExpected << endl;
+		if(handler.corrupted > 0) {
+			cout << "plain handler " << (j + 1) << " found " << handler.corrupted << " corrupted" << endl;
+		}
+	}
+	if(totalExpected > 0) {
+		cout << "missed " << totalExpected << endl;
+	}
+	plainProcessor.writeQueueStats(cout);
+	plainProcessor.terminate();
+}
+
+class ReactorAdder: public Runnable {
+	SyncQueue *queue;
+
+	int count;
+
+	void run() {
+		for(int i = 1; i <= count; i++) {
+			SampleQueueEntry1 data(i, "reactor", 8, DateTime(676868));
+			while(queue->add(data) < 0) {
+				/* the queue is full until the reactor catches up */
+				sched_yield();
+			}
+			if(i % 50 == 0) {
+				/* pause now and then, so that the reactor empties the queue and waits on the eventfd */
+				usleep(1000);
+			}
+		}
+	}
+public:
+	ReactorAdder(SyncQueue *queue, int count) :
+		queue(queue), count(count) {}
+};
+
+/*
+ * Removes entries with no consumer worker, as a thread running an event loop would,
+ * polling the queue's readiness eventfd while the queue is empty.
+ */
+void testReadinessReactor() {
+	QueueOptions options;
+	options.readinessEventFd = true;
+	Mutex stdoutLock;
+	SampleDataArray dataArray;
+	SyncQueue queue(64, &dataArray, &stdoutLock, true, options);
+	if(queue.getReadinessFd() < 0) {
+		cout << "no readiness eventfd on this platform" << endl;
+		return;
+	}
+	UINT_32 totalExpected = 1000;
+	ReaderIndex readerIndex(0);
+	queue.startAccess(readerIndex);
+	ReactorAdder adder(&queue, totalExpected);
+	Thread thread(&adder);
+	thread.start();
+	int polls = 0;
+	while(true) {
+		/* remove the entries found, then arm the eventfd, and remove again if entries arrived before it was armed */
+		do {
+			while(true) {
+				QueueEntryBase &entry = queue.remove(readerIndex);
+				if(!entry.isNull()) {
+					totalExpected--;
+					queue.release(readerIndex);
+				} else if(queue.isEmpty(readerIndex)) {
+					break;
+				}
+			}
+		} while(!queue.armReadiness(readerIndex));
+		if(totalExpected == 0) {
+			break;
+		}
+		struct pollfd readiness;
+		readiness.fd = queue.getReadinessFd();
+		readiness.events = POLLIN;
+		if(poll(&readiness, 1, 1000) <= 0) {
+			/* the eventfd is signalled once the next entry is added, so this is reached only if entries are lost */
+			break;
+		}
+		polls++;
+	}
+	thread.join();
+	queue.endAccess(readerIndex);
+	cout << "reactor polled the readiness eventfd " << polls << " times, remaining down to " << totalExpected << endl;
+	if(totalExpected > 0) {
+		cout << "missed " << totalExpected << endl;
+	}
+}
+
 int main() {
 	cout << "Starting " << endl;
 	int numWorkerThreads = 8;
@@ -154,8 +319,28 @@ int main() {
 		}
 		vector<Consumer *> consumers;
 		copy(sampleConsumers.begin(), sampleConsumers.end(), std::back_inserter(consumers));
-		dataArrays.push_back(new SampleDataArray);
-		processors.push_back(new QueueProducerInterface(dataArrays.back(), numWorkerThreads, consumers, 3 /* queue size */));
+		/* some of the queues take the strings in the entries from a payload arena rather than the heap, and some map their slots */
+		SlotStoragePolicy storagePolicy((i >= 3) ? SlotStoragePolicy::TRANSPARENT_HUGE_PAGES : SlotStoragePolicy::HEAP_PAGES, true);
+		dataArrays.push_back(new SampleDataArray((i % 2 == 1) ? 64 * 1024 : 0, storagePolicy));
+
+		/* alternate between the queue algorithms so they can be compared */
+		QueueOptions options;
+		options.lockFreeWriters = (i % 2 == 1);
+		options.powerOfTwoSize = (i % 4 >= 2);
+		options.maxRemoveBatchSize = (i >= 2) ? 16 : 1;
+		options.lockFreeReaders = (i >= 3);
+		options.onlineResize = (i == 4);
+		options.segmentSize = (i == 3) ? 8 : 0;
+		options.shrinkLowWatermark = (i <= 2) ? 25 : 0;
+		options.shrinkPeriodMillis = 100;
+		options.doorbellMaxAdds = (i >= 3) ? 32 : 0;
+		options.doorbellMaxMicros = (i >= 3) ? 100 : 0;
+		/* busy spinning is left out, since it suits only workers with cores of their own, and the sample has many workers */
+		static const WaitStrategy::Type waitTypes[] = {WaitStrategy::CONDITION_WAIT, WaitStrategy::SPIN_THEN_PARK, WaitStrategy::SPIN_THEN_YIELD};
+		options.waitStrategy = WaitStrategy(waitTypes[i % 3]);
+		/* one of the queues binds its slots to the first NUMA node, and pins its workers to the node's CPUs */
+		options.numaNode = (i == 1) ? 0 : -1;
+		processors.push_back(new QueueProducerInterface(dataArrays.back(), numWorkerThreads, consumers, 3 /* queue size */, options));
 		allConsumers.push_back(sampleConsumers);
 	}
 	//for(int i=0; i<numProcessors; i++) {
@@ -183,6 +368,9 @@ int main() {
 			cout << "missed " << totalExpected << endl;
 		}
 		processors[i]->writeQueueStats(cout);
+		if(dataArrays[i]->getPayloadArena()) {
+			cout << "payload arena allocations falling back to the heap: " << dataArrays[i]->getPayloadArena()->getFailedCount() << endl;
+		}
 		cout << "Terminating processor " << processors[i] << endl << endl;
 		processors[i]->terminate();
 	}
@@ -192,6 +380,12 @@ int main() {
 		delete dataArrays[i];
 	}
 
+	testTypedQueue();
+
+	testPlainDataQueue();
+
+	testReadinessReactor();
+
 	cout << endl << "Ending " << endl;
 	return 0;
 }
@@ -0,0 +1,97 @@
+#ifndef CPUSET_H_
+#define CPUSET_H_
+
+#include <pthread.h>
+#include <sched.h>
+#include <cstdio>
+
+namespace pthreadWrapper {
+
+/*
+ * A set of CPUs to which threads can be pinned.  An empty set places no restriction on a thread.
+ */
+class CpuSet {
+	cpu_set_t cpus;
+
+public:
+	CpuSet() {
+		CPU_ZERO(&cpus);
+	}
+
+	void add(int cpu) {
+		if(cpu >= 0 && cpu < CPU_SETSIZE) {
+			CPU_SET(cpu, &cpus);
+		}
+	}
+
+	/*
+	 * Adds the CPUs first to last inclusive.
+	 */
+	void add(int first, int last) {
+		for(int cpu = first; cpu <= last; cpu++) {
+			add(cpu);
+		}
+	}
+
+	bool contains(int cpu) const {
+		return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &cpus);
+	}
+
+	int count() const {
+		return CPU_COUNT(&cpus);
+	}
+
+	bool isEmpty() const {
+		return count() == 0;
+	}
+
+	const cpu_set_t &get() const {
+		return cpus;
+	}
+
+	/*
+	 * Pins the calling thread to the CPUs of the set, returning whether it succeeded.
+	 */
+	bool pinCurrentThread() const {
+		return !isEmpty() && pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+	}
+
+	/*
+	 * Returns the CPUs of the given NUMA node, as listed by the kernel in the node's cpulist such as 0-7,16-23,
+	 * or an empty set if the node is not known.  Only the CPUs the calling thread is allowed to run on are included,
+	 * since a cpuset or affinity mask may exclude some of the node's CPUs, and threads cannot be pinned to those.
+	 */
+	static CpuSet getNumaNodeCpus(int node) {
+		CpuSet result;
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+		FILE *file = fopen(path, "r");
+		if(file) {
+			int first, last;
+			while(fscanf(file, "%d", &first) == 1) {
+				last = first;
+				int separator = fgetc(file);
+				if(separator == '-') {
+					if(fscanf(file, "%d", &last) != 1) {
+						break;
+					}
+					separator = fgetc(file);
+				}
+				result.add(first, last);
+				if(separator != ',') {
+					break;
+				}
+			}
+			fclose(file);
+		}
+		cpu_set_t allowed;
+		if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+			CPU_AND(&result.cpus, &result.cpus, &allowed);
+		}
+		return result;
+	}
+};
+
+}
+
+#endif /* CPUSET_H_ */
@@ -0,0 +1,116 @@
+#ifndef EVENTCOUNT_H_
+#define EVENTCOUNT_H_
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#endif
+
+#include "Condition.h"
+
+namespace pthreadWrapper {
+
+/*
+ * Lets a thread sleep until another thread notifies it, with a futex rather than a mutex and condition,
+ * so that a notification costs no system call at all unless a thread is actually asleep.
+ *
+ * A waiting thread calls prepareWait, then checks once more for whatever it is waiting for,
+ * and then calls either cancelWait if it found it, or wait with the key returned by prepareWait.
+ * A notifying thread makes whatever is being waited for visible before calling notify.
+ * A notification made after prepareWait is never missed, since it changes the key and wait then returns at once.
+ *
+ * Where there is no futex, as on platforms other than Linux, threads sleep on a condition instead,
+ * which still costs a notification nothing unless a thread is waiting.
+ */
+class EventCount {
+	std::atomic<int> epoch;
+
+	std::atomic<int> waiters;
+
+#ifndef FUTEX_WAIT_PRIVATE
+	Mutex epochLock;
+
+	Condition epochChanged;
+#endif
+
+	EventCount(const EventCount &);
+
+	EventCount &operator=(const EventCount &);
+
+public:
+	EventCount() : epoch(0), waiters(0) {}
+
+	int prepareWait() {
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		/* orders the registration as a waiter before the waiter's next check, pairing with the fence in notify */
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return epoch.load(std::memory_order_acquire);
+	}
+
+	void cancelWait() {
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/*
+	 * Sleeps until notified after the call to prepareWait that returned the key, or until the timeout if not 0.
+	 * Returns false if the timeout elapsed.
+	 */
+	bool wait(int key, unsigned int timeoutMicros = 0) {
+		bool notified = true;
+#ifdef FUTEX_WAIT_PRIVATE
+		while(epoch.load(std::memory_order_acquire) == key) {
+			timespec timeout;
+			timeout.tv_sec = timeoutMicros / 1000000;
+			timeout.tv_nsec = (timeoutMicros % 1000000) * 1000;
+			long result = syscall(SYS_futex, &epoch, FUTEX_WAIT_PRIVATE, key, timeoutMicros ? &timeout : NULL, NULL, 0);
+			if(result != 0 && errno == ETIMEDOUT) {
+				notified = false;
+				break;
+			}
+		}
+#else
+		epochLock.acquire();
+		while(epoch.load(std::memory_order_acquire) == key) {
+			if(timeoutMicros) {
+				if(epochChanged.wait(epochLock, timeoutMicros) != 0) {
+					notified = (epoch.load(std::memory_order_acquire) != key);
+					break;
+				}
+			} else {
+				epochChanged.wait(epochLock);
+			}
+		}
+		epochLock.release();
+#endif
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+		return notified;
+	}
+
+	/*
+	 * Wakes the threads waiting, if any.
+	 */
+	void notify() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(waiters.load(std::memory_order_relaxed) > 0) {
+#ifdef FUTEX_WAIT_PRIVATE
+			epoch.fetch_add(1, std::memory_order_release);
+			syscall(SYS_futex, &epoch, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+			/* changed under the lock, so that a waiter cannot check the epoch and then miss the broadcast */
+			epochLock.acquire();
+			epoch.fetch_add(1, std::memory_order_release);
+			epochChanged.broadcast();
+			epochLock.release();
+#endif
+		}
+	}
+};
+
+}
+
+#endif /* EVENTCOUNT_H_ */
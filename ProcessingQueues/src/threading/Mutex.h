@@ -25,6 +25,13 @@ class Mutex {
 	void release() {
 		pthread_mutex_unlock(&mutex);
 	}
+
+	/*
+	 * Acquires the mutex if no other thread holds it, returning whether it was acquired.
+	 */
+	bool tryAcquire() {
+		return pthread_mutex_trylock(&mutex) == 0;
+	}
 	
 	~Mutex() {
 		pthread_mutex_destroy(&mutex);
@@ -2,10 +2,35 @@
 #define THREAD_H_
 
 #include <pthread.h>
+#include <sched.h>
+#include <string>
+#include "CpuSet.h"
 #include "Mutex.h"
 
 namespace pthreadWrapper {
 
+/*
+ * How a thread is created, see Thread::setConfig.  The defaults create a thread with default attributes.
+ */
+struct ThreadConfig {
+	/* the CPUs to pin the thread to, or empty to leave it unpinned */
+	CpuSet cpus;
+
+	/* the name shown for the thread by tools such as top and perf, truncated to the 15 characters the kernel keeps */
+	std::string name;
+
+	/* the size of the thread's stack in bytes, or 0 for the default size */
+	size_t stackSize;
+
+	/*
+	 * When non-zero, the thread is scheduled with SCHED_FIFO at this priority.
+	 * A process without the privilege to do so gets a thread with the default scheduling instead.
+	 */
+	int fifoPriority;
+
+	ThreadConfig() : stackSize(0), fifoPriority(0) {}
+};
+
 class Runnable {
 	friend class Thread;
 
@@ -16,28 +41,85 @@ protected:
 };
 
 class Thread {
-	pthread_t  thread;
-	Runnable  *runnable;
+	pthread_t    thread;
+	Runnable     *runnable;
+	ThreadConfig config;
 
 	virtual void run() {
 		runnable->run();
 	}
 
 	static void *threadEntry(void *runnable) {
-		static_cast<Thread *>(runnable)->run();
+		Thread *thread = static_cast<Thread *>(runnable);
+		if(!thread->config.name.empty()) {
+			pthread_setname_np(pthread_self(), thread->config.name.substr(0, 15).c_str());
+		}
+		thread->run();
 		return NULL;
 	}
 
+	int create(bool withPriority, bool withAffinity) {
+		pthread_attr_t _attr;
+		pthread_attr_init(&_attr);
+		if(withAffinity && !config.cpus.isEmpty()) {
+			pthread_attr_setaffinity_np(&_attr, sizeof(cpu_set_t), &config.cpus.get());
+		}
+		if(config.stackSize) {
+			pthread_attr_setstacksize(&_attr, config.stackSize);
+		}
+		if(withPriority) {
+			sched_param param;
+			param.sched_priority = config.fifoPriority;
+			pthread_attr_setinheritsched(&_attr, PTHREAD_EXPLICIT_SCHED);
+			pthread_attr_setschedpolicy(&_attr, SCHED_FIFO);
+			pthread_attr_setschedparam(&_attr, &param);
+		}
+		int result = pthread_create(&thread, &_attr, threadEntry, this);
+		pthread_attr_destroy(&_attr);
+		return result;
+	}
+
 public:
 	Thread(Runnable *runnable): thread (0), runnable(runnable) {}
 
 	virtual ~Thread() {}
 
-	void start() {
-		pthread_attr_t _attr;
-		pthread_attr_init(&_attr);
-		pthread_create(&thread, &_attr, threadEntry, this);
-		pthread_attr_destroy(&_attr);
+	/*
+	 * Sets how the thread is created when it starts.  Has no effect once the thread has started.
+	 */
+	void setConfig(const ThreadConfig &threadConfig) {
+		config = threadConfig;
+	}
+
+	const ThreadConfig &getConfig() const {
+		return config;
+	}
+
+	/*
+	 * Pins the thread to the given CPUs when it starts.  Has no effect once the thread has started.
+	 */
+	void setAffinity(const CpuSet &cpus) {
+		config.cpus = cpus;
+	}
+
+	void setName(const std::string &name) {
+		config.name = name;
+	}
+
+	/*
+	 * Creates the thread, returning whether it was created.
+	 * A thread that cannot be created with SCHED_FIFO, for lack of the privilege, is created with the default scheduling,
+	 * and a thread that cannot be pinned to its CPUs, such as CPUs outside the process's cpuset, is created unpinned.
+	 */
+	bool start() {
+		int result = config.fifoPriority ? create(true, true) : -1;
+		if(result != 0) {
+			result = create(false, true);
+		}
+		if(result != 0 && !config.cpus.isEmpty()) {
+			result = create(false, false);
+		}
+		return result == 0;
 	}
 
 	void join() {
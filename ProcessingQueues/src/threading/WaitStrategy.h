@@ -0,0 +1,49 @@
+#ifndef WAITSTRATEGY_H_
+#define WAITSTRATEGY_H_
+
+#include <sched.h>
+
+namespace pthreadWrapper {
+
+/*
+ * How a thread waits for work, trading the CPU time it burns while waiting against how quickly it wakes up.
+ */
+struct WaitStrategy {
+	enum Type {
+		/* sleeps on a mutex and condition, which the thread signalling work acquires and signals every time */
+		CONDITION_WAIT,
+
+		/* never sleeps, polling for work continuously, for threads with dedicated cores */
+		BUSY_SPIN,
+
+		/* polls for work spinCount times, then yields the CPU between polls */
+		SPIN_THEN_YIELD,
+
+		/*
+		 * polls for work spinCount times, then sleeps on a futex, or a condition where there is no futex, see EventCount.
+		 * The thread signalling work makes a system call only when the waiting thread is asleep.
+		 */
+		SPIN_THEN_PARK
+	};
+
+	Type type;
+
+	unsigned int spinCount;
+
+	WaitStrategy(Type type = CONDITION_WAIT, unsigned int spinCount = 1000) : type(type), spinCount(spinCount) {}
+
+	/*
+	 * Tells the processor the thread is spinning, so that it does not starve a hyperthread sharing its core.
+	 */
+	static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+};
+
+}
+
+#endif /* WAITSTRATEGY_H_ */